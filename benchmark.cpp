@@ -0,0 +1,636 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "include/circular_buffer.h"
+#include "include/clock_cache.h"
+#include "include/fir_filter.h"
+#include "include/spsc_circular_buffer.h"
+#include "include/timing_wheel.h"
+#include "include/work_stealing_deque.h"
+
+// Micro-benchmarks for CircularBuffer compared to std::deque and std::queue,
+// and for the containers built on it compared to their usual alternatives.
+//
+// Build with optimizations, for example:
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread benchmark.cpp -o benchmark
+// Usage:
+//   ./benchmark [results.json]
+
+typedef std::chrono::steady_clock Clock;
+
+constexpr std::chrono::milliseconds kMinTime(5);  // Per repetition
+constexpr int kRepetitions = 3;                   // The fastest one is used
+
+template <size_t BYTES>
+struct Element {
+  uint8_t data[BYTES];
+};
+
+/// @brief Prevent the compiler from optimizing away the computation of value.
+template <typename T>
+inline void keep(const T& value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct Result {
+  const char* container;
+  const char* operation;
+  size_t element_size;
+  size_t size;
+  double ns_per_op;
+  double hit_rate = -1;  // Only for caches
+};
+
+std::vector<Result> results;
+
+/**
+ * @brief Call batch until kMinTime has elapsed, kRepetitions times, and record
+ * the fastest time per operation.
+ *
+ * @param batch Runs ops operations and returns the time the operations took
+ */
+template <typename Batch>
+void run(const char* container, const char* operation, size_t element_size,
+         size_t size, size_t ops, Batch batch) {
+  double best = 0;
+  for (int repetition = 0; repetition < kRepetitions; ++repetition) {
+    Clock::duration total{0};
+    size_t count = 0;
+    while (total < kMinTime) {
+      total += batch();
+      count += ops;
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(total).count() / count;
+    if (repetition == 0 || ns < best) best = ns;
+  }
+  results.push_back(Result{container, operation, element_size, size, best});
+  printf("%-14s %-10s %4zu B %6zu %10.2f ns/op %14.0f ops/s\n", container,
+         operation, element_size, size, best, 1e9 / best);
+}
+
+template <typename T, size_t SIZE>
+struct CircularBufferAdapter {
+  static constexpr const char* kName = "CircularBuffer";
+  static constexpr bool kIterable = true;
+
+  void Push(const T& value) { this->buffer.Push(value); }
+  void PushForce(const T& value) { this->buffer.PushForce(value); }
+  void Pop() { this->buffer.Pop(); }
+  const T& Peek() { return this->buffer.Front(); }
+  void Clear() { this->buffer.Clear(); }
+  template <typename F>
+  void ForEach(F f) {
+    for (const T& value : this->buffer) f(value);
+  }
+
+  CircularBuffer<T, SIZE> buffer;
+};
+
+template <typename T, size_t SIZE>
+struct DequeAdapter {
+  static constexpr const char* kName = "std::deque";
+  static constexpr bool kIterable = true;
+
+  void Push(const T& value) { this->deque.push_back(value); }
+  void PushForce(const T& value) {
+    if (this->deque.size() == SIZE) this->deque.pop_front();
+    this->deque.push_back(value);
+  }
+  void Pop() { this->deque.pop_front(); }
+  const T& Peek() { return this->deque.front(); }
+  void Clear() { this->deque.clear(); }
+  template <typename F>
+  void ForEach(F f) {
+    for (const T& value : this->deque) f(value);
+  }
+
+  std::deque<T> deque;
+};
+
+template <typename T, size_t SIZE>
+struct QueueAdapter {
+  static constexpr const char* kName = "std::queue";
+  static constexpr bool kIterable = false;
+
+  void Push(const T& value) { this->queue.push(value); }
+  void PushForce(const T& value) {
+    if (this->queue.size() == SIZE) this->queue.pop();
+    this->queue.push(value);
+  }
+  void Pop() { this->queue.pop(); }
+  const T& Peek() { return this->queue.front(); }
+  void Clear() { this->queue = std::queue<T>(); }
+
+  std::queue<T> queue;
+};
+
+template <template <typename, size_t> class Adapter, size_t BYTES, size_t SIZE>
+void benchmark_container() {
+  typedef Element<BYTES> T;
+  typedef Adapter<T, SIZE> Container;
+  const char* name = Container::kName;
+  Container container;
+  T value{};
+
+  // Push into an empty container until it is full
+  run(name, "Push", BYTES, SIZE, SIZE, [&]() {
+    container.Clear();
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < SIZE; ++i) {
+      value.data[0] = uint8_t(i);
+      container.Push(value);
+    }
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(container);
+    return elapsed;
+  });
+  // Pop from a full container until it is empty
+  run(name, "Pop", BYTES, SIZE, SIZE, [&]() {
+    container.Clear();
+    for (size_t i = 0; i < SIZE; ++i) container.Push(value);
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < SIZE; ++i) container.Pop();
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(container);
+    return elapsed;
+  });
+
+  // The remaining operations all work on a full container
+  container.Clear();
+  for (size_t i = 0; i < SIZE; ++i) container.Push(value);
+
+  run(name, "PushForce", BYTES, SIZE, SIZE, [&]() {
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < SIZE; ++i) {
+      value.data[0] = uint8_t(i);
+      container.PushForce(value);
+    }
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(container);
+    return elapsed;
+  });
+  run(name, "Peek", BYTES, SIZE, SIZE, [&]() {
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < SIZE; ++i) keep(container.Peek().data[0]);
+    return Clock::now() - start;
+  });
+  if constexpr (Container::kIterable) {
+    run(name, "Iterate", BYTES, SIZE, SIZE, [&]() {
+      uint32_t sum = 0;
+      const Clock::time_point start = Clock::now();
+      container.ForEach([&](const T& element) { sum += element.data[0]; });
+      keep(sum);
+      return Clock::now() - start;
+    });
+  }
+}
+
+template <size_t BYTES, size_t SIZE>
+void benchmark_size() {
+  benchmark_container<CircularBufferAdapter, BYTES, SIZE>();
+  benchmark_container<DequeAdapter, BYTES, SIZE>();
+  benchmark_container<QueueAdapter, BYTES, SIZE>();
+}
+
+template <size_t BYTES>
+void benchmark_element() {
+  benchmark_size<BYTES, 16>();
+  benchmark_size<BYTES, 1000>();  // Not a power of two
+  benchmark_size<BYTES, 1024>();
+  benchmark_size<BYTES, 16384>();
+}
+
+// TimingWheel compared to a binary heap, with kTimers timers that expire
+// within kMaxDelay ticks. Cancelling is lazy for the heap (a flag that is
+// checked when the timer reaches the top), which is the usual approach.
+constexpr size_t kTimers = 1000000;
+constexpr uint64_t kMaxDelay = 1 << 20;
+
+void benchmark_timers() {
+  typedef TimingWheel<> Wheel;
+  typedef std::pair<uint64_t, uint32_t> Entry;  // Expires, timer index
+  typedef std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+      Heap;
+
+  std::mt19937_64 random(42);
+  std::vector<uint64_t> delays(kTimers);
+  for (uint64_t& delay : delays) delay = 1 + random() % kMaxDelay;
+  std::vector<Wheel::Timer> timers(kTimers);
+  std::vector<uint8_t> cancelled(kTimers);
+
+  auto schedule_wheel = [&](Wheel& wheel) {
+    for (size_t i = 0; i < kTimers; ++i) wheel.Schedule(&timers[i], delays[i]);
+  };
+  auto schedule_heap = [&](Heap& heap) {
+    for (size_t i = 0; i < kTimers; ++i)
+      heap.push(Entry{delays[i], uint32_t(i)});
+  };
+
+  run("TimingWheel", "Schedule", sizeof(Wheel::Timer), kTimers, kTimers,
+      [&]() {
+        Wheel wheel;
+        const Clock::time_point start = Clock::now();
+        schedule_wheel(wheel);
+        const Clock::duration elapsed = Clock::now() - start;
+        for (Wheel::Timer& timer : timers) wheel.Cancel(&timer);
+        return elapsed;
+      });
+  run("TimingWheel", "Cancel", sizeof(Wheel::Timer), kTimers, kTimers, [&]() {
+    Wheel wheel;
+    schedule_wheel(wheel);
+    const Clock::time_point start = Clock::now();
+    for (Wheel::Timer& timer : timers) wheel.Cancel(&timer);
+    return Clock::now() - start;
+  });
+  run("TimingWheel", "Expire", sizeof(Wheel::Timer), kTimers, kTimers, [&]() {
+    Wheel wheel;
+    schedule_wheel(wheel);
+    size_t expired = 0;
+    const Clock::time_point start = Clock::now();
+    wheel.Advance(kMaxDelay, [&](Wheel::Timer*) { ++expired; });
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(expired);
+    return elapsed;
+  });
+
+  run("priority_queue", "Schedule", sizeof(Entry), kTimers, kTimers, [&]() {
+    Heap heap;
+    const Clock::time_point start = Clock::now();
+    schedule_heap(heap);
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(heap);
+    return elapsed;
+  });
+  run("priority_queue", "Cancel", sizeof(Entry), kTimers, kTimers, [&]() {
+    Heap heap;
+    schedule_heap(heap);
+    std::fill(cancelled.begin(), cancelled.end(), 0);
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < kTimers; ++i) cancelled[i] = 1;
+    // Cancelled timers are only removed when they reach the top
+    while (!heap.empty()) heap.pop();
+    return Clock::now() - start;
+  });
+  run("priority_queue", "Expire", sizeof(Entry), kTimers, kTimers, [&]() {
+    Heap heap;
+    schedule_heap(heap);
+    std::fill(cancelled.begin(), cancelled.end(), 0);
+    size_t expired = 0;
+    const Clock::time_point start = Clock::now();
+    for (uint64_t now = 1; now <= kMaxDelay; ++now) {
+      while (!heap.empty() && heap.top().first <= now) {
+        if (!cancelled[heap.top().second]) ++expired;
+        heap.pop();
+      }
+    }
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(expired);
+    return elapsed;
+  });
+}
+
+// FirFilter compared to filtering with a scalar loop over the iterator of a
+// CircularBuffer that holds the last TAPS samples.
+template <size_t TAPS>
+void benchmark_fir() {
+  constexpr size_t kSamples = 4096;
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  float taps[TAPS];
+  for (float& tap : taps) tap = distribution(random);
+  std::vector<float> input(kSamples), output(kSamples);
+  for (float& sample : input) sample = distribution(random);
+
+  CircularBuffer<float, TAPS> history;
+  for (size_t i = 0; i < TAPS; ++i) history.Push(0.0f);
+  run("CircularBuffer", "FirScalar", sizeof(float), TAPS, kSamples, [&]() {
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < kSamples; ++i) {
+      history.PushForce(input[i]);
+      // The oldest sample is at the front, so it pairs with the last tap
+      float acc = 0;
+      const float* tap = &taps[TAPS - 1];
+      for (const float& sample : history) acc += *(tap--) * sample;
+      output[i] = acc;
+    }
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(output[kSamples - 1]);
+    return elapsed;
+  });
+
+  FirFilter<TAPS> filter(taps);
+  run("FirFilter", "Fir", sizeof(float), TAPS, kSamples, [&]() {
+    const Clock::time_point start = Clock::now();
+    filter.Process(input.data(), output.data(), kSamples);
+    const Clock::duration elapsed = Clock::now() - start;
+    keep(output[kSamples - 1]);
+    return elapsed;
+  });
+}
+
+// ClockCache compared to a std::list based LRU cache, on a Zipf distributed
+// stream of keys. Every miss inserts the key. The keys are used as they are,
+// so std::hash (the identity for integers on libstdc++) is all the mixing
+// there is: the ranks themselves, and the ranks times 4096 like page aligned
+// addresses.
+constexpr size_t kCacheCapacity = 10000;
+constexpr size_t kCacheKeys = 100000;
+constexpr size_t kCacheRequests = 1000000;
+
+class ListLru {
+ public:
+  int Get(uint64_t key, uint64_t** value) {
+    auto it = this->index_.find(key);
+    if (it == this->index_.end()) return -1;
+    this->list_.splice(this->list_.begin(), this->list_, it->second);
+    *value = &it->second->second;
+    return 0;
+  }
+  void Put(uint64_t key, uint64_t value) {
+    if (this->index_.size() == kCacheCapacity) {
+      this->index_.erase(this->list_.back().first);
+      this->list_.pop_back();
+    }
+    this->list_.emplace_front(key, value);
+    this->index_[key] = this->list_.begin();
+  }
+
+ private:
+  typedef std::list<std::pair<uint64_t, uint64_t>> List;
+
+  List list_;
+  std::unordered_map<uint64_t, List::iterator> index_;
+};
+
+template <typename Cache>
+void benchmark_cache(const char* name, const char* operation,
+                     const std::vector<uint64_t>& keys) {
+  size_t hits = 0;
+  run(name, operation, sizeof(uint64_t), kCacheCapacity, keys.size(), [&]() {
+    std::unique_ptr<Cache> cache(new Cache());
+    hits = 0;
+    const Clock::time_point start = Clock::now();
+    for (uint64_t key : keys) {
+      uint64_t* value;
+      if (cache->Get(key, &value) == 0)
+        ++hits;
+      else
+        cache->Put(key, key);
+    }
+    return Clock::now() - start;
+  });
+  results.back().hit_rate = double(hits) / double(keys.size());
+  printf("%-14s hit rate %.2f%%\n", name, 100 * results.back().hit_rate);
+}
+
+void benchmark_caches() {
+  // Zipf distribution with s = 0.99, sampled from its cumulative distribution
+  std::vector<double> cdf(kCacheKeys);
+  double sum = 0;
+  for (size_t i = 0; i < kCacheKeys; ++i) {
+    sum += 1.0 / std::pow(double(i + 1), 0.99);
+    cdf[i] = sum;
+  }
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<double> distribution(0, sum);
+  std::vector<uint64_t> keys(kCacheRequests), aligned(kCacheRequests);
+  for (size_t i = 0; i < kCacheRequests; ++i) {
+    keys[i] = std::lower_bound(cdf.begin(), cdf.end(), distribution(random)) -
+              cdf.begin();
+    aligned[i] = keys[i] * 4096;
+  }
+
+  typedef ClockCache<uint64_t, uint64_t, kCacheCapacity> Cache;
+  benchmark_cache<Cache>("ClockCache", "GetOrPut", keys);
+  benchmark_cache<ListLru>("ListLru", "GetOrPut", keys);
+  benchmark_cache<Cache>("ClockCache", "Aligned", aligned);
+  benchmark_cache<ListLru>("ListLru", "Aligned", aligned);
+}
+
+// SpscCircularBuffer compared to a CircularBuffer behind a std::mutex, with
+// one producer and one consumer thread that pass kTransfers values. A full or
+// empty buffer is retried after a yield, so the time includes the waiting of
+// both threads.
+constexpr size_t kTransfers = 1000000;
+
+template <size_t SIZE>
+struct MutexCircularBuffer {
+  int Push(const uint64_t& value) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->buffer.Push(value);
+  }
+  int Pop(uint64_t* value) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->buffer.Pop(value);
+  }
+
+  std::mutex mutex;
+  CircularBuffer<uint64_t, SIZE> buffer;
+};
+
+template <typename Buffer>
+Clock::duration transfer(Buffer& buffer) {
+  uint64_t sum = 0;
+  const Clock::time_point start = Clock::now();
+  std::thread consumer([&]() {
+    uint64_t value;
+    for (size_t i = 0; i < kTransfers; ++i) {
+      while (buffer.Pop(&value) != 0) std::this_thread::yield();
+      sum += value;
+    }
+  });
+  for (uint64_t i = 0; i < kTransfers; ++i) {
+    while (buffer.Push(i) != 0) std::this_thread::yield();
+  }
+  consumer.join();
+  const Clock::duration elapsed = Clock::now() - start;
+  keep(sum);
+  return elapsed;
+}
+
+template <size_t SIZE>
+void benchmark_spsc() {
+  run("SpscBuffer", "Transfer", sizeof(uint64_t), SIZE, kTransfers, [&]() {
+    std::unique_ptr<SpscCircularBuffer<uint64_t, SIZE>> buffer(
+        new SpscCircularBuffer<uint64_t, SIZE>());
+    return transfer(*buffer);
+  });
+  run("MutexBuffer", "Transfer", sizeof(uint64_t), SIZE, kTransfers, [&]() {
+    std::unique_ptr<MutexCircularBuffer<SIZE>> buffer(
+        new MutexCircularBuffer<SIZE>());
+    return transfer(*buffer);
+  });
+}
+
+// A fork/join workload on a thread pool of kWorkers threads. Every task splits
+// its range in two until kGrain items are left, and the pool is done when all
+// kForkJoinItems items are processed. Each worker owns a WorkStealingDeque and
+// steals from the others when it runs out of tasks, compared to a pool that
+// shares one std::deque behind a std::mutex.
+constexpr size_t kWorkers = 4;
+constexpr uint32_t kForkJoinItems = 1 << 20;
+constexpr uint32_t kGrain = 256;
+constexpr size_t kLeafTasks = kForkJoinItems / kGrain;
+
+struct Range {
+  uint32_t begin, end;
+};
+
+/**
+ * @brief Split range in two until kGrain items are left, handing every upper
+ * half to push, then process the rest.
+ *
+ * @return uint32_t The amount of items processed
+ */
+template <typename Push>
+uint32_t process(Range range, Push push) {
+  while (range.end - range.begin > kGrain) {
+    const uint32_t middle = range.begin + (range.end - range.begin) / 2;
+    push(Range{middle, range.end});
+    range.end = middle;
+  }
+  uint64_t sum = 0;
+  for (uint32_t i = range.begin; i < range.end; ++i) sum += uint64_t(i) * i;
+  keep(sum);
+  return range.end - range.begin;
+}
+
+/**
+ * @brief Run worker(id) on kWorkers threads (one of them the calling thread)
+ * and return the time between the start signal and the last join.
+ */
+template <typename Worker>
+Clock::duration run_pool(Worker worker) {
+  std::atomic<bool> start{false};
+  std::vector<std::thread> threads;
+  for (size_t id = 1; id < kWorkers; ++id) {
+    threads.emplace_back([&, id]() {
+      while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+      worker(id);
+    });
+  }
+  const Clock::time_point begin = Clock::now();
+  start.store(true, std::memory_order_release);
+  worker(0);
+  for (std::thread& thread : threads) thread.join();
+  return Clock::now() - begin;
+}
+
+void benchmark_fork_join() {
+  run("WorkStealing", "ForkJoin", sizeof(Range), kWorkers, kLeafTasks, [&]() {
+    std::vector<std::unique_ptr<WorkStealingDeque<Range>>> deques;
+    for (size_t id = 0; id < kWorkers; ++id)
+      deques.emplace_back(new WorkStealingDeque<Range>());
+    deques[0]->Push(Range{0, kForkJoinItems});
+    std::atomic<uint32_t> done{0};
+
+    return run_pool([&](size_t id) {
+      WorkStealingDeque<Range>& own = *deques[id];
+      size_t victim = id;
+      while (done.load(std::memory_order_acquire) < kForkJoinItems) {
+        Range range;
+        if (own.Pop(&range) != 0) {
+          victim = (victim + 1) % kWorkers;
+          if (victim == id || deques[victim]->Steal(&range) != 0) {
+            std::this_thread::yield();
+            continue;
+          }
+        }
+        done.fetch_add(process(range, [&](Range half) { own.Push(half); }),
+                       std::memory_order_release);
+      }
+    });
+  });
+  run("MutexDeque", "ForkJoin", sizeof(Range), kWorkers, kLeafTasks, [&]() {
+    std::mutex mutex;
+    std::deque<Range> tasks{Range{0, kForkJoinItems}};
+    std::atomic<uint32_t> done{0};
+
+    return run_pool([&](size_t) {
+      while (done.load(std::memory_order_acquire) < kForkJoinItems) {
+        Range range;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!tasks.empty()) {
+            range = tasks.back();
+            tasks.pop_back();
+          } else {
+            range = Range{0, 0};
+          }
+        }
+        if (range.begin == range.end) {
+          std::this_thread::yield();
+          continue;
+        }
+        done.fetch_add(process(range,
+                               [&](Range half) {
+                                 std::lock_guard<std::mutex> lock(mutex);
+                                 tasks.push_back(half);
+                               }),
+                       std::memory_order_release);
+      }
+    });
+  });
+}
+
+int write_json(const char* path) {
+  FILE* file = fopen(path, "w");
+  if (!file) return -1;
+  fprintf(file, "{\n  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    fprintf(file,
+            "    {\"container\": \"%s\", \"operation\": \"%s\", "
+            "\"element_size\": %zu, \"size\": %zu, \"ns_per_op\": %.3f, "
+            "\"ops_per_s\": %.0f",
+            result.container, result.operation, result.element_size,
+            result.size, result.ns_per_op, 1e9 / result.ns_per_op);
+    if (result.hit_rate >= 0)
+      fprintf(file, ", \"hit_rate\": %.4f", result.hit_rate);
+    fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+  return fclose(file) == 0 ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "benchmark.json";
+
+  benchmark_element<1>();
+  benchmark_element<8>();
+  benchmark_element<32>();
+  benchmark_element<64>();
+  benchmark_element<256>();
+  benchmark_spsc<64>();
+  benchmark_spsc<1024>();
+  benchmark_fork_join();
+  benchmark_timers();
+  benchmark_fir<16>();
+  benchmark_fir<64>();
+  benchmark_fir<256>();
+  benchmark_caches();
+
+  if (write_json(path) != 0) {
+    printf("Could not write %s\n", path);
+    return 1;
+  }
+  printf("Results written to %s\n", path);
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include <stdio.h>
+
+#include <memory_resource>
+#include <string>
+
+#include "include/dynamic_circular_buffer.h"
+
+// Checks that DynamicCircularBuffer follows the allocator propagation rules,
+// using std::pmr::polymorphic_allocator which never propagates.
+//
+//   g++ -std=c++17 dynamic_circular_buffer_test.cpp -o test && ./test
+
+typedef std::pmr::polymorphic_allocator<std::string> Allocator;
+typedef DynamicCircularBuffer<std::string, Allocator> Buffer;
+
+/// @brief A memory resource that counts the bytes it has handed out.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    this->allocated += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    this->allocated -= bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("Failed: %s\n", what);
+    ++failures;
+  }
+}
+
+/// @brief Fill a buffer with count strings that do not fit in the SSO buffer.
+void fill(Buffer& buffer, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    buffer.Push(std::string(32, char('a' + i)));
+}
+
+int main() {
+  CountingResource a, b;
+  {
+    Buffer x(4, Allocator(&a)), y(8, Allocator(&b));
+    fill(y, 6);
+    x.Pop();  // Start at an offset, so the copy wraps around
+
+    // Copy: x keeps resource a and takes the capacity of y
+    x = y;
+    check(x.Size() == 6 && x.MaxSize() == 8, "copy assignment size");
+    check(x.Front() == std::string(32, 'a'), "copy assignment contents");
+    const size_t b_before = b.allocated;
+    x.PushForce(std::string(32, 'z'));
+    check(b.allocated == b_before, "copy assignment allocator");
+    check(a.allocated > 0, "copy assignment uses resource a");
+
+    // Move between unequal resources: the elements are moved one by one
+    Buffer z(8, Allocator(&b));
+    fill(z, 3);
+    const size_t a_before = a.allocated;
+    x = std::move(z);
+    check(x.Size() == 3 && x.Front() == std::string(32, 'a'),
+          "move assignment contents");
+    check(z.Empty(), "moved from buffer is empty");
+    check(a.allocated == a_before, "move assignment reuses resource a");
+
+    // Move between equal resources: the buffer is adopted
+    Buffer w(2, Allocator(&a));
+    w = std::move(x);
+    check(w.Size() == 3 && w.MaxSize() == 8, "adopting move assignment");
+    check(x.MaxSize() == 0, "adopted buffer is released");
+  }
+  check(a.allocated == 0 && b.allocated == 0, "all memory released");
+
+  if (failures == 0) printf("Success\n");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file blocking_circular_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A single-producer/single-consumer circular buffer where the producer
+ * and consumer can block until there is space or data
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "spsc_circular_buffer.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#elif !defined(__cpp_lib_atomic_wait)
+#error "BlockingCircularBuffer needs Linux or C++20 (std::atomic::wait)"
+#endif
+
+/**
+ * @brief A SpscCircularBuffer with blocking PushWait and PopWait.
+ *
+ * A blocked side sleeps on a 32 bit epoch counter and announces it with a
+ * waiting flag. On Linux it calls the futex syscall directly rather than
+ * `std::atomic::wait`, so it works with C++17 and supports a timeout.
+ * Elsewhere it falls back to `std::atomic::wait`, which needs C++20. The
+ * other side only bumps the epoch and wakes it when that flag is set, which
+ * only happens on the transition from empty to non-empty (or full to
+ * non-full). So when nobody is waiting Push and Pop make no syscalls.
+ *
+ * The waiting flag and the indices need a store-load barrier on both sides.
+ * On Linux the side that is about to sleep issues it for both with
+ * membarrier(2), so Push and Pop only need a compiler barrier. Elsewhere (or
+ * when membarrier is not available) every Push and Pop pays a full fence.
+ *
+ * @tparam T The type of the static buffer
+ * @tparam SIZE The length of the buffer
+ */
+template <typename T, size_t SIZE>
+class BlockingCircularBuffer : public SpscCircularBuffer<T, SIZE> {
+  using Base = SpscCircularBuffer<T, SIZE>;
+  using Clock = std::chrono::steady_clock;
+
+ public:
+  BlockingCircularBuffer() : asymmetric_(register_membarrier_()) {}
+
+  /**
+   * @brief Push data to the end of the buffer, without waiting. May only be
+   * called from the producer thread.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(const T& data) {
+    if (Base::Push(data) != 0) return -1;
+    this->notify_(this->not_empty_, this->pop_waiting_);
+    return 0;
+  }
+  /**
+   * @brief Get the data that is at the front of the buffer, without waiting.
+   * May only be called from the consumer thread.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(T* data) {
+    if (Base::Pop(data) != 0) return -1;
+    this->notify_(this->not_full_, this->push_waiting_);
+    return 0;
+  }
+  /**
+   * @brief Remove the data this is at the front of the buffer, without
+   * waiting. May only be called from the consumer thread.
+   *
+   * @return int Returns 0 on success, -1 when there is no data.
+   */
+  int Pop() {
+    if (Base::Pop() != 0) return -1;
+    this->notify_(this->not_full_, this->push_waiting_);
+    return 0;
+  }
+  /**
+   * @brief Push data to the end of the buffer, wait until there is space.
+   *
+   * @param data[in]
+   * @return int Always returns 0
+   */
+  int PushWait(const T& data) { return this->push_wait_(data, nullptr); }
+  /**
+   * @brief Push data to the end of the buffer, wait at most timeout until there
+   * is space.
+   *
+   * @param data[in]
+   * @param timeout The maximum time to wait
+   * @return int Return 0 on success, -1 when still out of space after timeout.
+   */
+  template <typename Rep, typename Period>
+  int PushWait(const T& data,
+               const std::chrono::duration<Rep, Period>& timeout) {
+    const Clock::time_point deadline =
+        Clock::now() + std::chrono::ceil<Clock::duration>(timeout);
+    return this->push_wait_(data, &deadline);
+  }
+  /**
+   * @brief Get the data that is at the front of the buffer, wait until there is
+   * data.
+   *
+   * @param data[out]
+   * @return int Always returns 0
+   */
+  int PopWait(T* data) { return this->pop_wait_(data, nullptr); }
+  /**
+   * @brief Get the data that is at the front of the buffer, wait at most
+   * timeout until there is data.
+   *
+   * @param data[out]
+   * @param timeout The maximum time to wait
+   * @return int Returns 0 on success, -1 when there is still no data after
+   * timeout.
+   */
+  template <typename Rep, typename Period>
+  int PopWait(T* data, const std::chrono::duration<Rep, Period>& timeout) {
+    const Clock::time_point deadline =
+        Clock::now() + std::chrono::ceil<Clock::duration>(timeout);
+    return this->pop_wait_(data, &deadline);
+  }
+
+ protected:
+  // Consumer waits on not_empty_, the producer on not_full_.
+  alignas(Base::kCacheLineSize) std::atomic<uint32_t> not_empty_{0};
+  std::atomic<bool> pop_waiting_{false};
+  alignas(Base::kCacheLineSize) std::atomic<uint32_t> not_full_{0};
+  std::atomic<bool> push_waiting_{false};
+  // The sleeping side issues the barrier for both sides (membarrier)
+  bool asymmetric_;
+
+  int push_wait_(const T& data, const Clock::time_point* deadline) {
+    while (this->Push(data) != 0) {
+      const uint32_t epoch = this->not_full_.load(std::memory_order_acquire);
+      this->push_waiting_.store(true, std::memory_order_relaxed);
+      this->heavy_fence_();
+      const bool woken =
+          this->Full() ? wait_(this->not_full_, epoch, deadline) : true;
+      this->push_waiting_.store(false, std::memory_order_relaxed);
+      if (!woken) return this->Push(data);
+    }
+    return 0;
+  }
+  int pop_wait_(T* data, const Clock::time_point* deadline) {
+    while (this->Pop(data) != 0) {
+      const uint32_t epoch = this->not_empty_.load(std::memory_order_acquire);
+      this->pop_waiting_.store(true, std::memory_order_relaxed);
+      this->heavy_fence_();
+      const bool woken =
+          this->Empty() ? wait_(this->not_empty_, epoch, deadline) : true;
+      this->pop_waiting_.store(false, std::memory_order_relaxed);
+      if (!woken) return this->Pop(data);
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Wake the other side, but only when it announced it is waiting.
+   * The fence pairs with heavy_fence_ in push_wait_/pop_wait_, so either the
+   * waiter sees the new index or we see its waiting flag.
+   */
+  void notify_(std::atomic<uint32_t>& epoch,
+               const std::atomic<bool>& waiting) const {
+    if (this->asymmetric_)
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+    else
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!waiting.load(std::memory_order_relaxed)) return;
+    epoch.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE,
+            1, nullptr, nullptr, 0);
+#else
+    epoch.notify_one();
+#endif
+  }
+  /// @brief A full fence that also orders the memory accesses of the other
+  /// side, when that side only uses a compiler barrier.
+  void heavy_fence_() const {
+#if defined(__linux__)
+    if (this->asymmetric_) {
+      syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+      return;
+    }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+  /// @brief Register the process for membarrier, once.
+  static bool register_membarrier_() {
+#if defined(__linux__)
+    static const bool registered =
+        syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0,
+                0) == 0;
+    return registered;
+#else
+    return false;
+#endif
+  }
+  /**
+   * @brief Sleep while epoch still equals expected.
+   *
+   * @return bool Returns false when the deadline passed.
+   */
+  static bool wait_(std::atomic<uint32_t>& epoch, uint32_t expected,
+                    const Clock::time_point* deadline) {
+#if defined(__linux__)
+    while (epoch.load(std::memory_order_acquire) == expected) {
+      timespec ts;
+      timespec* timeout = nullptr;
+      if (deadline) {
+        const auto remaining = *deadline - Clock::now();
+        if (remaining <= Clock::duration::zero()) return false;
+        const auto ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+                .count();
+        ts.tv_sec = time_t(ns / 1000000000);
+        ts.tv_nsec = long(ns % 1000000000);
+        timeout = &ts;
+      }
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch),
+              FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+    }
+    return true;
+#else
+    if (!deadline) {
+      epoch.wait(expected, std::memory_order_acquire);
+      return true;
+    }
+    // std::atomic::wait has no timeout, poll instead
+    while (epoch.load(std::memory_order_acquire) == expected) {
+      if (Clock::now() >= *deadline) return false;
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
+#endif
+  }
+};
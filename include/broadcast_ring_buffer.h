@@ -0,0 +1,191 @@
+/**
+ * @file broadcast_ring_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A single-producer ring where every consumer has its own cursor, so
+ * every consumer sees every element
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief A disruptor style broadcast ring with one producer thread and up to
+ * MAX_CONSUMERS consumer threads.
+ *
+ * The producer publishes elements by advancing its cursor (the sequence
+ * barrier). Every registered consumer has its own cursor, popping an element
+ * only advances that consumer. The producer can only overwrite a slot when
+ * the slowest registered consumer is done with it, otherwise Push returns -1.
+ *
+ * The cursors are free-running counters, each on its own cache line. The
+ * producer caches the slowest cursor and only scans the consumers again when
+ * it catches up with that cached value.
+ *
+ * @tparam T The type of the static buffer
+ * @tparam SIZE The length of the buffer
+ * @tparam MAX_CONSUMERS The maximum amount of registered consumers
+ */
+template <typename T, size_t SIZE, size_t MAX_CONSUMERS = 8>
+class BroadcastRingBuffer {
+  static_assert(SIZE > 0, "BroadcastRingBuffer requires a non-zero SIZE");
+
+ public:
+  static constexpr size_t kCacheLineSize = 64;
+
+  /**
+   * @brief Register a new consumer, it receives every element pushed after
+   * this call. Can be called from any thread.
+   *
+   * @return int The id of the consumer, -1 when MAX_CONSUMERS are registered
+   */
+  int Register() {
+    for (size_t i = 0; i < MAX_CONSUMERS; ++i) {
+      Cursor& cursor = this->cursors_[i];
+      uint8_t expected = kFree;
+      if (!cursor.state.compare_exchange_strong(expected, kRegistering))
+        continue;
+      // Start with a conservative cursor, so the producer can not overwrite
+      // anything we might read once it sees this consumer.
+      cursor.position.store(this->tail_.load(), std::memory_order_relaxed);
+      cursor.state.store(kActive);
+      const size_t position = this->tail_.load();
+      cursor.cached_tail = position;
+      cursor.position.store(position, std::memory_order_release);
+      return int(i);
+    }
+    return -1;
+  }
+  /**
+   * @brief Remove a consumer, the producer no longer waits for it. Must be
+   * called from the thread of that consumer.
+   *
+   * @param consumer The id returned by Register
+   */
+  void Unregister(int consumer) {
+    this->cursors_[consumer].state.store(kFree, std::memory_order_release);
+  }
+
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+  /**
+   * @brief Return the amount of elements a consumer has not popped yet.
+   *
+   * @param consumer The id returned by Register
+   * @return size_t
+   */
+  size_t Size(int consumer) const {
+    return this->tail_.load(std::memory_order_acquire) -
+           this->cursors_[consumer].position.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Push data to the end of the buffer. May only be called from the
+   * producer thread.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when the slowest consumer has not yet
+   * popped the element that would be overwritten.
+   */
+  int Push(const T& data) {
+    const size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail - this->cached_min_ >= SIZE) {
+      this->cached_min_ = this->slowest_(tail);
+      if (tail - this->cached_min_ >= SIZE) return -1;
+    }
+    this->buffer_[tail % SIZE] = data;
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return 0;
+  }
+  /**
+   * @brief Get the next element for a consumer. May only be called from the
+   * thread of that consumer.
+   *
+   * @param consumer The id returned by Register
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(int consumer, T* data) {
+    const T* element;
+    if (this->Peek(consumer, &element) != 0) return -1;
+    *data = *element;
+    return this->Pop(consumer);
+  }
+  /**
+   * @brief Skip the next element for a consumer. May only be called from the
+   * thread of that consumer.
+   *
+   * @param consumer The id returned by Register
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(int consumer) {
+    Cursor& cursor = this->cursors_[consumer];
+    const size_t position = cursor.position.load(std::memory_order_relaxed);
+    if (position == cursor.cached_tail) {
+      cursor.cached_tail = this->tail_.load(std::memory_order_acquire);
+      if (position == cursor.cached_tail) return -1;
+    }
+    cursor.position.store(position + 1, std::memory_order_release);
+    return 0;
+  }
+  /**
+   * @brief Get the next element for a consumer, without removing it. May only
+   * be called from the thread of that consumer.
+   *
+   * @param consumer The id returned by Register
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Peek(int consumer, const T** data) {
+    Cursor& cursor = this->cursors_[consumer];
+    const size_t position = cursor.position.load(std::memory_order_relaxed);
+    if (position == cursor.cached_tail) {
+      cursor.cached_tail = this->tail_.load(std::memory_order_acquire);
+      if (position == cursor.cached_tail) return -1;
+    }
+    *data = &this->buffer_[position % SIZE];
+    return 0;
+  }
+
+ protected:
+  static constexpr uint8_t kFree = 0;
+  static constexpr uint8_t kRegistering = 1;
+  static constexpr uint8_t kActive = 2;
+
+  struct alignas(kCacheLineSize) Cursor {
+    std::atomic<size_t> position{0};
+    std::atomic<uint8_t> state{kFree};
+    size_t cached_tail{0};  // Only used by the consumer
+  };
+
+  /// @brief Return the cursor of the slowest active consumer, or tail if there
+  /// are none.
+  size_t slowest_(size_t tail) const {
+    // Pairs with Register: either we see the new consumer, or it sees our
+    // latest tail as its starting point.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    size_t min = tail;
+    for (const Cursor& cursor : this->cursors_) {
+      if (cursor.state.load() != kActive) continue;
+      const size_t position = cursor.position.load(std::memory_order_acquire);
+      if (tail - position > tail - min) min = position;
+    }
+    return min;
+  }
+
+  T buffer_[SIZE];
+  // Producer side
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  size_t cached_min_{0};
+  // Consumer side
+  Cursor cursors_[MAX_CONSUMERS];
+};
@@ -0,0 +1,228 @@
+/**
+ * @file channel.h
+ * @author Wouter (wjtje)
+ * @brief A bounded channel for C++20 coroutines built on CircularBuffer, with a
+ * minimal single-threaded executor
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "circular_buffer.h"
+
+class Executor;
+
+/**
+ * @brief A fire-and-forget coroutine. It does not start until it is given to
+ * Executor::Spawn, and frees itself when it finishes.
+ */
+class Task {
+ public:
+  struct promise_type {
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() {
+    // Only destroy a task that was never spawned
+    if (this->handle_) this->handle_.destroy();
+  }
+
+ private:
+  friend class Executor;
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief A single-threaded executor that resumes ready coroutines in FIFO
+ * order.
+ */
+class Executor {
+ public:
+  /**
+   * @brief Start a task, it runs the next time Run is called.
+   *
+   * @param task
+   */
+  void Spawn(Task task) { this->Schedule(std::exchange(task.handle_, {})); }
+  /**
+   * @brief Resume handle the next time Run is called.
+   *
+   * @param handle
+   */
+  void Schedule(std::coroutine_handle<> handle) {
+    this->ready_.push_back(handle);
+  }
+  /**
+   * @brief Resume coroutines until none are ready. Coroutines that are still
+   * suspended on a Channel afterwards are blocked forever.
+   */
+  void Run() {
+    while (!this->ready_.empty()) {
+      std::coroutine_handle<> handle = this->ready_.front();
+      this->ready_.pop_front();
+      handle.resume();
+    }
+  }
+
+ private:
+  std::deque<std::coroutine_handle<>> ready_;
+};
+
+/**
+ * @brief A bounded channel between coroutines, using a CircularBuffer.
+ *
+ * `co_await channel.Push(x)` suspends while the channel is full and
+ * `co_await channel.Pop()` suspends while it is empty. A suspended coroutine
+ * is rescheduled on the executor by the opposite operation. Values are handed
+ * over directly to a suspended coroutine, so it can not be overtaken by
+ * another coroutine once it is rescheduled.
+ *
+ * The waiting coroutines are kept in intrusive lists inside their awaiters, so
+ * suspending does not allocate.
+ *
+ * @tparam T The type of the elements
+ * @tparam SIZE The length of the buffer
+ */
+template <typename T, size_t SIZE>
+class Channel {
+ public:
+  class PushAwaiter {
+   public:
+    bool await_ready() { return this->channel_.try_push_(this->value_); }
+    void await_suspend(std::coroutine_handle<> handle) {
+      this->handle_ = handle;
+      this->channel_.pushers_.Append(this);
+    }
+    void await_resume() {}
+
+   private:
+    friend class Channel;
+    PushAwaiter(Channel& channel, T value)
+        : channel_(channel), value_(std::move(value)) {}
+
+    Channel& channel_;
+    T value_;
+    std::coroutine_handle<> handle_;
+    PushAwaiter* next_{nullptr};
+  };
+
+  class PopAwaiter {
+   public:
+    bool await_ready() { return this->channel_.try_pop_(&this->value_); }
+    void await_suspend(std::coroutine_handle<> handle) {
+      this->handle_ = handle;
+      this->channel_.poppers_.Append(this);
+    }
+    T await_resume() { return std::move(*this->value_); }
+
+   private:
+    friend class Channel;
+    explicit PopAwaiter(Channel& channel) : channel_(channel) {}
+
+    Channel& channel_;
+    std::optional<T> value_;
+    std::coroutine_handle<> handle_;
+    PopAwaiter* next_{nullptr};
+  };
+
+  explicit Channel(Executor& executor) : executor_(executor) {}
+  Channel(const Channel&) = delete;
+  Channel& operator=(const Channel&) = delete;
+
+  /**
+   * @brief Push data to the end of the channel, suspends while it is full.
+   *
+   * @param data[in]
+   * @return PushAwaiter
+   */
+  PushAwaiter Push(T data) { return PushAwaiter(*this, std::move(data)); }
+  /**
+   * @brief Get the data that is at the front of the channel, suspends while
+   * it is empty.
+   *
+   * @return PopAwaiter The result of co_await is the element
+   */
+  PopAwaiter Pop() { return PopAwaiter(*this); }
+
+  /**
+   * @brief Return the amount of buffered elements.
+   *
+   * @return size_t
+   */
+  size_t Size() const { return this->buffer_.Size(); }
+  /**
+   * @brief Return the size (capacity) of the channel.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+
+ private:
+  /// @brief A FIFO of suspended awaiters, linked through their next_ member.
+  template <typename Awaiter>
+  struct WaitList {
+    Awaiter* head{nullptr};
+    Awaiter* tail{nullptr};
+
+    bool Empty() const { return head == nullptr; }
+    void Append(Awaiter* awaiter) {
+      if (tail)
+        tail->next_ = awaiter;
+      else
+        head = awaiter;
+      tail = awaiter;
+    }
+    Awaiter* Take() {
+      Awaiter* awaiter = head;
+      head = awaiter->next_;
+      if (!head) tail = nullptr;
+      return awaiter;
+    }
+  };
+
+  bool try_push_(T& value) {
+    if (!this->poppers_.Empty()) {
+      // The buffer is empty, give the value to the first waiting coroutine
+      PopAwaiter* popper = this->poppers_.Take();
+      popper->value_.emplace(std::move(value));
+      this->executor_.Schedule(popper->handle_);
+      return true;
+    }
+    return this->buffer_.Push(std::move(value)) == 0;
+  }
+  bool try_pop_(std::optional<T>* value) {
+    if (this->buffer_.Empty()) return false;
+    value->emplace(this->buffer_.DirectPop());
+    if (!this->pushers_.Empty()) {
+      // There is space now, finish the push of the first waiting coroutine
+      PushAwaiter* pusher = this->pushers_.Take();
+      this->buffer_.Push(std::move(pusher->value_));
+      this->executor_.Schedule(pusher->handle_);
+    }
+    return true;
+  }
+
+  Executor& executor_;
+  CircularBuffer<T, SIZE> buffer_;
+  WaitList<PushAwaiter> pushers_;
+  WaitList<PopAwaiter> poppers_;
+};
@@ -8,16 +8,27 @@
  * @copyright Copyright (c) 2024 wjtje. MIT License
  */
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 /**
- * @brief A basic circular buffer using a static buffer
+ * @brief The head and tail bookkeeping of a CircularBuffer.
+ *
+ * The generic version keeps wrapped indices plus a `full_` flag, so it works
+ * for any SIZE.
  *
- * @tparam T The type of the static buffer
  * @tparam SIZE The length of the buffer
+ * @tparam POWER_OF_TWO Selects the specialization for power of two sizes
  */
-template <typename T, size_t SIZE>
-class CircularBuffer {
+template <size_t SIZE, bool POWER_OF_TWO = (SIZE & (SIZE - 1)) == 0>
+class CircularBufferIndices {
  public:
   /**
    * @brief Return true when the buffer is full.
@@ -40,12 +51,6 @@ class CircularBuffer {
     this->tail_ = 0;
     this->head_ = 0;
   }
-  /**
-   * @brief Return the size (capacity) of the buffer.
-   *
-   * @return size_t
-   */
-  inline constexpr size_t MaxSize() const { return SIZE; }
   /**
    * @brief Return the amount of elements in the buffer, this is between 0 and
    * size.
@@ -57,37 +62,299 @@ class CircularBuffer {
     if (this->tail_ >= this->head_) return this->tail_ - this->head_;
     return SIZE + this->tail_ - this->head_;
   }
+
+ protected:
+  size_t tail_{0}, head_{0};
+  bool full_{false};
+
+  size_t head_index_() const { return this->head_; }
+  size_t tail_index_() const { return this->tail_; }
+  /// @brief Wrap an index, it must be smaller than 2 * SIZE.
+  static size_t wrap_index_(size_t index) {
+    return index >= SIZE ? index - SIZE : index;
+  }
+
+  void advance_pointer_() {
+    if (this->full_)
+      if (++(this->head_) == SIZE) this->head_ = 0;
+    if (++(this->tail_) == SIZE) this->tail_ = 0;
+    this->full_ = (this->tail_ == this->head_);
+  }
+  void retreat_pointer_() {
+    this->full_ = false;
+    if (++(this->head_) == SIZE) this->head_ = 0;
+  }
+  /// @brief Advance the tail by count, count must fit in the free space.
+  void advance_tail_(size_t count) {
+    if (count == 0) return;
+    this->tail_ += count;
+    if (this->tail_ >= SIZE) this->tail_ -= SIZE;
+    this->full_ = (this->tail_ == this->head_);
+  }
+  /// @brief Advance the head by count, count may not exceed Size().
+  void advance_head_(size_t count) {
+    if (count == 0) return;
+    this->head_ += count;
+    if (this->head_ >= SIZE) this->head_ -= SIZE;
+    this->full_ = false;
+  }
+};
+
+/**
+ * @brief The head and tail bookkeeping for power of two sizes.
+ *
+ * The head and tail are free-running counters that are masked with SIZE-1
+ * when used as an index. They are SIZE apart when the buffer is full, so no
+ * `full_` flag and no wrap branches are needed and Size() is a subtraction.
+ *
+ * @tparam SIZE The length of the buffer
+ */
+template <size_t SIZE>
+class CircularBufferIndices<SIZE, true> {
+ public:
+  /**
+   * @brief Return true when the buffer is full.
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Full() const { return (this->tail_ - this->head_) == SIZE; }
+  /**
+   * @brief Return true when the buffer is empty
+   *
+   * @return true
+   * @return false
+   */
+  constexpr bool Empty() const { return this->tail_ == this->head_; }
+  void Clear() {
+    this->tail_ = 0;
+    this->head_ = 0;
+  }
+  /**
+   * @brief Return the amount of elements in the buffer, this is between 0 and
+   * size.
+   *
+   * @return size_t
+   */
+  size_t Size() const { return this->tail_ - this->head_; }
+
+ protected:
+  static constexpr size_t kMask = SIZE - 1;
+
+  size_t tail_{0}, head_{0};
+
+  size_t head_index_() const { return this->head_ & kMask; }
+  size_t tail_index_() const { return this->tail_ & kMask; }
+  /// @brief Wrap an index, it must be smaller than 2 * SIZE.
+  static size_t wrap_index_(size_t index) { return index & kMask; }
+
+  void advance_pointer_() {
+    this->head_ += (this->tail_ - this->head_) == SIZE;
+    ++(this->tail_);
+  }
+  void retreat_pointer_() { ++(this->head_); }
+  /// @brief Advance the tail by count, count must fit in the free space.
+  void advance_tail_(size_t count) { this->tail_ += count; }
+  /// @brief Advance the head by count, count may not exceed Size().
+  void advance_head_(size_t count) { this->head_ += count; }
+};
+
+/**
+ * @brief The default instrumentation policy of a CircularBuffer. Every hook is
+ * empty and the class is an empty base, so it costs nothing.
+ *
+ * A policy is a base class of the CircularBuffer, its public members become
+ * part of the buffer (for example CircularBufferCounters::Snapshot).
+ *
+ * Copying or moving a buffer does not call any hook. A copy gets a copy of
+ * the policy state, a move transfers it and leaves the moved-from buffer with
+ * a default constructed policy. So a policy must be default constructible and
+ * copyable.
+ *
+ * A policy that keeps per element state for a buffer of a fixed length (like
+ * SojournRecorder) declares that length as `static constexpr size_t kSize`,
+ * the CircularBuffer then checks that it matches its own SIZE.
+ */
+class NoInstrumentation {
+ protected:
+  /// @brief count elements were pushed, the buffer now holds size elements.
+  void on_push_(size_t /*count*/, size_t /*size*/) {}
+  /// @brief count elements were not pushed because the buffer was full.
+  void on_reject_(size_t /*count*/) {}
+  /// @brief PushForce overwrote (and removed) the element at the front.
+  void on_overwrite_() {}
+  /// @brief count elements were removed from the front.
+  void on_pop_(size_t /*count*/) {}
+  /// @brief All elements were removed by Clear.
+  void on_clear_() {}
+};
+
+/**
+ * @brief The length an instrumentation policy was written for, its kSize, or
+ * SIZE when it does not depend on the length.
+ */
+template <typename Instrumentation, size_t SIZE, typename = void>
+struct InstrumentationSize : std::integral_constant<size_t, SIZE> {};
+template <typename Instrumentation, size_t SIZE>
+struct InstrumentationSize<Instrumentation, SIZE,
+                           std::void_t<decltype(Instrumentation::kSize)>>
+    : std::integral_constant<size_t, Instrumentation::kSize> {};
+
+/**
+ * @brief A basic circular buffer using a static buffer
+ *
+ * The static buffer is uninitialized storage, elements are only constructed
+ * when they are pushed and destroyed when they are popped. So T does not have
+ * to be default constructible and move-only types like `std::unique_ptr` can
+ * be stored.
+ *
+ * When SIZE is a power of two a cheaper, branch free, index implementation is
+ * selected at compile time.
+ *
+ * @tparam T The type of the static buffer
+ * @tparam SIZE The length of the buffer
+ * @tparam Instrumentation A policy that is told about every push, pop, reject
+ * and overwrite, see NoInstrumentation
+ */
+template <typename T, size_t SIZE,
+          typename Instrumentation = NoInstrumentation>
+class CircularBuffer : public CircularBufferIndices<SIZE>,
+                       public Instrumentation {
+  static_assert(InstrumentationSize<Instrumentation, SIZE>::value == SIZE,
+                "The instrumentation policy is for a buffer of another SIZE");
+
+ public:
+  /**
+   * @brief A contiguous range of elements inside the buffer.
+   */
+  struct Span {
+    T* data;
+    size_t size;
+
+    T* begin() const { return data; }
+    T* end() const { return data + size; }
+    bool Empty() const { return size == 0; }
+  };
+
+  CircularBuffer() = default;
+  CircularBuffer(const CircularBuffer& other)
+      : CircularBufferIndices<SIZE>(other), Instrumentation(other) {
+    this->for_each_index_([&](size_t i) {
+      ::new (static_cast<void*>(&this->data_()[i])) T(other.data_()[i]);
+    });
+  }
+  CircularBuffer(CircularBuffer&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T> &&
+      std::is_nothrow_move_constructible_v<Instrumentation>)
+      : CircularBufferIndices<SIZE>(other),
+        Instrumentation(std::move(other)) {
+    this->for_each_index_([&](size_t i) {
+      ::new (static_cast<void*>(&this->data_()[i]))
+          T(std::move(other.data_()[i]));
+    });
+    other.reset_();
+  }
+  CircularBuffer& operator=(const CircularBuffer& rhs) {
+    if (this != &rhs) {
+      this->clear_elements_();
+      CircularBufferIndices<SIZE>::operator=(rhs);
+      Instrumentation::operator=(rhs);
+      this->for_each_index_([&](size_t i) {
+        ::new (static_cast<void*>(&this->data_()[i])) T(rhs.data_()[i]);
+      });
+    }
+    return *this;
+  }
+  CircularBuffer& operator=(CircularBuffer&& rhs) noexcept(
+      std::is_nothrow_move_constructible_v<T> &&
+      std::is_nothrow_move_assignable_v<Instrumentation>) {
+    if (this != &rhs) {
+      this->clear_elements_();
+      CircularBufferIndices<SIZE>::operator=(rhs);
+      Instrumentation::operator=(std::move(rhs));
+      this->for_each_index_([&](size_t i) {
+        ::new (static_cast<void*>(&this->data_()[i]))
+            T(std::move(rhs.data_()[i]));
+      });
+      rhs.reset_();
+    }
+    return *this;
+  }
+  ~CircularBuffer() { this->destroy_(this->head_index_(), this->Size()); }
+
+  /**
+   * @brief Remove (and destroy) all elements in the buffer.
+   */
+  void Clear() {
+    this->clear_elements_();
+    this->on_clear_();
+  }
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
   /**
    * @brief Push data to the end of the buffer.
    *
    * @param data[in]
    * @return int Return 0 on success, -1 when out of space.
    */
-  int Push(const T& data) {
-    if (this->full_) return -1;
-    this->buffer_[this->tail_] = data;
+  int Push(const T& data) { return this->Emplace(data); }
+  /**
+   * @brief Move data to the end of the buffer.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(T&& data) { return this->Emplace(std::move(data)); }
+  /**
+   * @brief Construct an element in place at the end of the buffer.
+   *
+   * @param args[in] The arguments passed to the constructor of T
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  template <typename... Args>
+  int Emplace(Args&&... args) {
+    if (this->Full()) {
+      this->on_reject_(1);
+      return -1;
+    }
+    ::new (static_cast<void*>(&this->data_()[this->tail_index_()]))
+        T(std::forward<Args>(args)...);
     this->advance_pointer_();
+    this->on_push_(1, this->Size());
     return 0;
   }
   /**
    * @brief Push data to the end of the buffer, even if the buffer is full.
+   * When full the oldest element is destroyed and replaced.
    *
    * @param data[in]
    */
-  void PushForce(const T& data) {
-    this->buffer_[this->tail_] = data;
-    this->advance_pointer_();
-  }
+  void PushForce(const T& data) { this->push_force_(data); }
   /**
-   * @brief Get the data that is at the front of the buffer
+   * @brief Move data to the end of the buffer, even if the buffer is full.
+   * When full the oldest element is destroyed and replaced.
+   *
+   * @param data[in]
+   */
+  void PushForce(T&& data) { this->push_force_(std::move(data)); }
+  /**
+   * @brief Get the data that is at the front of the buffer. The element is
+   * moved out and removed from the buffer.
    *
    * @param data[out]
    * @return int Returns 0 on success, -1 when there is no data
    */
   int Pop(T* data) {
     if (this->Empty()) return -1;
-    *data = this->buffer_[this->head_];
+    T& front = this->data_()[this->head_index_()];
+    *data = std::move(front);
+    std::destroy_at(&front);
     this->retreat_pointer_();
+    this->on_pop_(1);
     return 0;
   }
   /**
@@ -97,19 +364,129 @@ class CircularBuffer {
    */
   int Pop() {
     if (this->Empty()) return -1;
+    std::destroy_at(&this->data_()[this->head_index_()]);
     this->retreat_pointer_();
+    this->on_pop_(1);
+    return 0;
+  }
+  /**
+   * @brief Push up to count elements to the end of the buffer. The data is
+   * copied in at most two contiguous segments and the indices are updated
+   * once.
+   *
+   * @param data[in]
+   * @param count The amount of elements in data
+   * @return size_t The amount of elements pushed, this is less than count when
+   * the buffer ran out of space.
+   */
+  size_t PushN(const T* data, size_t count) {
+    const size_t n = std::min(count, SIZE - this->Size());
+    if (n < count) this->on_reject_(count - n);
+    if (n == 0) return 0;
+    const size_t tail = this->tail_index_();
+    const size_t first = std::min(n, SIZE - tail);
+    copy_in_(&this->data_()[tail], data, first);
+    copy_in_(this->data_(), data + first, n - first);
+    this->advance_tail_(n);
+    this->on_push_(n, this->Size());
+    return n;
+  }
+  /**
+   * @brief Get up to count elements from the front of the buffer. The data is
+   * moved out in at most two contiguous segments and the indices are updated
+   * once.
+   *
+   * @param data[out]
+   * @param count The amount of elements that fit in data
+   * @return size_t The amount of elements popped, this is less than count when
+   * the buffer ran out of data.
+   */
+  size_t PopN(T* data, size_t count) {
+    const size_t n = std::min(count, this->Size());
+    if (n == 0) return 0;
+    const size_t head = this->head_index_();
+    const size_t first = std::min(n, SIZE - head);
+    move_out_(data, &this->data_()[head], first);
+    move_out_(data + first, this->data_(), n - first);
+    this->advance_head_(n);
+    this->on_pop_(n);
+    return n;
+  }
+  /**
+   * @brief Get direct access to the free space at the end of the buffer, so it
+   * can be written in place. Call WriteCommit to add the written elements to
+   * the buffer. Only available for trivially copyable types, because the free
+   * space holds no constructed objects.
+   *
+   * @param max The maximum amount of elements that will be written
+   * @return Span A contiguous writable range of at most max elements, this is
+   * empty when the buffer is full.
+   */
+  Span WriteAcquire(size_t max = SIZE) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WriteAcquire requires a trivially copyable T");
+    const size_t tail = this->tail_index_();
+    const size_t n = std::min({max, SIZE - this->Size(), SIZE - tail});
+    return Span{&this->data_()[tail], n};
+  }
+  /**
+   * @brief Add count elements, written in place after WriteAcquire, to the end
+   * of the buffer.
+   *
+   * @param count The amount of elements written
+   * @return int Returns 0 on success, -1 when count exceeds the free space.
+   */
+  int WriteCommit(size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WriteCommit requires a trivially copyable T");
+    if (count > SIZE - this->Size()) return -1;
+    this->advance_tail_(count);
+    this->on_push_(count, this->Size());
+    return 0;
+  }
+  /**
+   * @brief Get direct access to the data at the front of the buffer, so it can
+   * be read in place. Call ReadRelease to remove the read elements from the
+   * buffer.
+   *
+   * @param max The maximum amount of elements that will be read
+   * @return Span A contiguous range of at most max elements, this is empty when
+   * the buffer is empty.
+   */
+  Span ReadAcquire(size_t max = SIZE) {
+    const size_t head = this->head_index_();
+    const size_t n = std::min({max, this->Size(), SIZE - head});
+    return Span{&this->data_()[head], n};
+  }
+  /**
+   * @brief Remove (and destroy) count elements, read in place after
+   * ReadAcquire, from the front of the buffer.
+   *
+   * @param count The amount of elements read
+   * @return int Returns 0 on success, -1 when count exceeds the amount of
+   * elements in the buffer.
+   */
+  int ReadRelease(size_t count) {
+    if (count > this->Size()) return -1;
+    this->destroy_(this->head_index_(), count);
+    this->advance_head_(count);
+    this->on_pop_(count);
     return 0;
   }
   /**
    * @brief Direct pop.
-   * Get the data that is at the front of the buffer. Even if that data is
-   * invalid.
+   * Get the data that is at the front of the buffer, without checking if there
+   * is any.
+   * @warning The buffer may not be empty.
    *
-   * @return const T& A reference to that value
+   * @return T The element that was at the front
    */
-  const T& DirectPop() {
-    T& d = this->buffer_[this->head_];
+  T DirectPop() {
+    T& front = this->data_()[this->head_index_()];
+    T d = std::move(front);
+    std::destroy_at(&front);
     this->retreat_pointer_();
+    this->on_pop_(1);
     return d;
   }
   /**
@@ -120,7 +497,7 @@ class CircularBuffer {
    */
   int Peek(T** data) {
     if (this->Empty()) return -1;
-    *data = &this->buffer_[this->head_];
+    *data = &this->data_()[this->head_index_()];
     return 0;
   }
   /**
@@ -129,63 +506,265 @@ class CircularBuffer {
    *
    * @return T&
    */
-  T& Front() { return this->buffer_[this->head_]; }
+  T& Front() { return this->data_()[this->head_index_()]; }
 
-  struct Iterator {
-    Iterator(size_t position, T* buffer, bool is_tail)
-        : position_(position), buffer_(buffer), is_head_(is_tail) {}
+  /**
+   * @brief A random-access iterator over the elements, from front to back.
+   *
+   * It stores the offset from the front, so moving it is O(1) and there is no
+   * difference between begin() and end() of a full buffer.
+   *
+   * @tparam CONST Iterate over const elements
+   */
+  template <bool CONST>
+  class BasicIterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<CONST, const T*, T*>;
+    using reference = std::conditional_t<CONST, const T&, T&>;
+
+    BasicIterator() = default;
+    BasicIterator(pointer buffer, size_t head, size_t offset)
+        : buffer_(buffer), head_(head), offset_(offset) {}
+    /// @brief A non-const iterator converts to a const iterator.
+    operator BasicIterator<true>() const {
+      return BasicIterator<true>(this->buffer_, this->head_, this->offset_);
+    }
 
-    T& operator*() const { return buffer_[position_]; }
-    T* operator->() { return &buffer_[position_]; }
-    T& operator=(const T& p) { return buffer_[position_] = p; }
+    reference operator*() const { return this->buffer_[this->index_()]; }
+    pointer operator->() const { return &this->buffer_[this->index_()]; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+    template <bool C = CONST, typename = std::enable_if_t<!C>>
+    T& operator=(const T& p) const {
+      return this->buffer_[this->index_()] = p;
+    }
     /**
      * @brief Get access to the pointer of the current item of the Iterator.
      * This can be used to update an item that's already in the queue.
      *
-     * @return T&
+     * @return reference
      */
-    T& Get() { return buffer_[position_]; }
-    const T& Get() const { return buffer_[position_]; }
+    reference Get() const { return this->buffer_[this->index_()]; }
 
-    Iterator& operator++() {
-      if (++position_ == SIZE) position_ = 0;
-      is_head_ = false;
+    BasicIterator& operator++() {
+      ++(this->offset_);
       return *this;
     }
-    Iterator operator++(int) {
-      Iterator tmp = *this;
+    BasicIterator operator++(int) {
+      BasicIterator tmp = *this;
       ++(*this);
       return tmp;
     }
+    BasicIterator& operator--() {
+      --(this->offset_);
+      return *this;
+    }
+    BasicIterator operator--(int) {
+      BasicIterator tmp = *this;
+      --(*this);
+      return tmp;
+    }
+    BasicIterator& operator+=(difference_type n) {
+      this->offset_ += size_t(n);
+      return *this;
+    }
+    BasicIterator& operator-=(difference_type n) {
+      this->offset_ -= size_t(n);
+      return *this;
+    }
+    friend BasicIterator operator+(BasicIterator it, difference_type n) {
+      return it += n;
+    }
+    friend BasicIterator operator+(difference_type n, BasicIterator it) {
+      return it += n;
+    }
+    friend BasicIterator operator-(BasicIterator it, difference_type n) {
+      return it -= n;
+    }
+    friend difference_type operator-(const BasicIterator& a,
+                                     const BasicIterator& b) {
+      return difference_type(a.offset_ - b.offset_);
+    }
 
-    friend bool operator==(const Iterator& a, const Iterator& b) {
-      return a.position_ == b.position_ && a.is_head_ == b.is_head_;
+    friend bool operator==(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ == b.offset_;
+    }
+    friend bool operator!=(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ != b.offset_;
     }
-    friend bool operator!=(const Iterator& a, const Iterator& b) {
-      return a.position_ != b.position_ || a.is_head_ != b.is_head_;
+    friend bool operator<(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ < b.offset_;
+    }
+    friend bool operator>(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ > b.offset_;
+    }
+    friend bool operator<=(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ <= b.offset_;
+    }
+    friend bool operator>=(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ >= b.offset_;
     }
 
-    size_t position_;
-    T* buffer_;
-    bool is_head_;  // Indicated the tail (begin) of the iterator
+   private:
+    size_t index_() const {
+      return CircularBuffer::wrap_index_(this->head_ + this->offset_);
+    }
+
+    pointer buffer_{nullptr};
+    size_t head_{0};    // Index of the front of the buffer
+    size_t offset_{0};  // Offset from the front, between 0 and Size()
   };
 
-  Iterator begin() { return Iterator(this->head_, this->buffer_, true); }
-  Iterator end() { return Iterator(this->tail_, this->buffer_, this->Empty()); }
+  using Iterator = BasicIterator<false>;
+  using ConstIterator = BasicIterator<true>;
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+  Iterator begin() { return Iterator(this->data_(), this->head_index_(), 0); }
+  Iterator end() {
+    return Iterator(this->data_(), this->head_index_(), this->Size());
+  }
+  ConstIterator begin() const {
+    return ConstIterator(this->data_(), this->head_index_(), 0);
+  }
+  ConstIterator end() const {
+    return ConstIterator(this->data_(), this->head_index_(), this->Size());
+  }
+  ConstIterator cbegin() const { return this->begin(); }
+  ConstIterator cend() const { return this->end(); }
+
+  /**
+   * @brief Get access to the element at index, counted from the front.
+   * @warning index must be smaller than Size().
+   *
+   * @param index
+   * @return T&
+   */
+  T& operator[](size_t index) {
+    return this->data_()[this->wrap_index_(this->head_index_() + index)];
+  }
+  const T& operator[](size_t index) const {
+    return this->data_()[this->wrap_index_(this->head_index_() + index)];
+  }
+  /**
+   * @brief Get the element at index, counted from the front.
+   *
+   * @param index
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when index is out of range
+   */
+  int At(size_t index, T** data) {
+    if (index >= this->Size()) return -1;
+    *data = &(*this)[index];
+    return 0;
+  }
+  /**
+   * @brief Get the elements as (at most) two contiguous ranges, from front to
+   * back. The second range is empty when the elements do not wrap around.
+   *
+   * @return std::array<Span, 2>
+   */
+  std::array<Span, 2> Segments() {
+    const size_t head = this->head_index_();
+    const size_t size = this->Size();
+    const size_t first = std::min(size, SIZE - head);
+    return {Span{&this->data_()[head], first},
+            Span{this->data_(), size - first}};
+  }
+  /**
+   * @brief Get the free space as (at most) two contiguous ranges, from the end
+   * of the buffer onwards. Write to them and call WriteCommit, like
+   * WriteAcquire but without stopping at the end of the static buffer. Only
+   * available for trivially copyable types.
+   *
+   * @return std::array<Span, 2>
+   */
+  std::array<Span, 2> FreeSegments() {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "FreeSegments requires a trivially copyable T");
+    const size_t tail = this->tail_index_();
+    const size_t free = SIZE - this->Size();
+    const size_t first = std::min(free, SIZE - tail);
+    return {Span{&this->data_()[tail], first},
+            Span{this->data_(), free - first}};
+  }
 
  protected:
-  T buffer_[SIZE];
-  size_t tail_{0}, head_{0};
-  bool full_{false};
+  alignas(T) unsigned char buffer_[SIZE * sizeof(T)];
 
-  void advance_pointer_() {
-    if (this->full_)
-      if (++(this->head_) == SIZE) this->head_ = 0;
-    if (++(this->tail_) == SIZE) this->tail_ = 0;
-    this->full_ = (this->tail_ == this->head_);
+  T* data_() { return std::launder(reinterpret_cast<T*>(this->buffer_)); }
+  const T* data_() const {
+    return std::launder(reinterpret_cast<const T*>(this->buffer_));
   }
-  void retreat_pointer_() {
-    this->full_ = false;
-    if (++(this->head_) == SIZE) this->head_ = 0;
+
+  /// @brief Destroy all elements without telling the instrumentation.
+  void clear_elements_() {
+    this->destroy_(this->head_index_(), this->Size());
+    CircularBufferIndices<SIZE>::Clear();
+  }
+  /// @brief Empty a moved-from buffer and give it a fresh instrumentation.
+  void reset_() {
+    this->clear_elements_();
+    static_cast<Instrumentation&>(*this) = Instrumentation();
+  }
+  template <typename U>
+  void push_force_(U&& data) {
+    T* slot = &this->data_()[this->tail_index_()];
+    if (this->Full()) {
+      this->on_overwrite_();
+      // The oldest element is in the slot, pushing it again only rotates
+      if (static_cast<const void*>(std::addressof(data)) != slot) {
+        std::destroy_at(slot);
+        // Drop it first, so a throwing constructor leaves a valid buffer
+        this->retreat_pointer_();
+        ::new (static_cast<void*>(slot)) T(std::forward<U>(data));
+      }
+    } else {
+      ::new (static_cast<void*>(slot)) T(std::forward<U>(data));
+    }
+    this->advance_pointer_();
+    this->on_push_(1, this->Size());
+  }
+  /// @brief Call f with the index of every element, from front to back.
+  template <typename F>
+  void for_each_index_(F f) const {
+    size_t index = this->head_index_();
+    for (size_t i = this->Size(); i > 0; --i) {
+      f(index);
+      if (++index == SIZE) index = 0;
+    }
+  }
+  /// @brief Destroy count elements, starting at index and wrapping around.
+  void destroy_(size_t index, size_t count) {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (; count > 0; --count) {
+        std::destroy_at(&this->data_()[index]);
+        if (++index == SIZE) index = 0;
+      }
+    }
+  }
+  /// @brief Construct count elements in uninitialized storage from src.
+  static void copy_in_(T* dst, const T* src, size_t count) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (count) std::memcpy(dst, src, count * sizeof(T));
+    } else {
+      std::uninitialized_copy(src, src + count, dst);
+    }
+  }
+  /// @brief Move count elements out of the buffer and destroy them.
+  static void move_out_(T* dst, T* src, size_t count) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (count) std::memcpy(dst, src, count * sizeof(T));
+    } else {
+      std::move(src, src + count, dst);
+      std::destroy(src, src + count);
+    }
   }
 };
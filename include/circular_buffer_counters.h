@@ -0,0 +1,99 @@
+/**
+ * @file circular_buffer_counters.h
+ * @author Wouter (wjtje)
+ * @brief An instrumentation policy that counts what happens to a
+ * CircularBuffer
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Counts the pushes, pops, rejected pushes and overwrites of a
+ * CircularBuffer and keeps its peak Size().
+ *
+ * @code
+ * CircularBuffer<Event, 256, CircularBufferCounters> events;
+ * CircularBufferCounters::Counters counters = events.Snapshot();
+ * @endcode
+ *
+ * The counters are only changed by the thread that uses the buffer, so they
+ * are updated with a relaxed load and store instead of a locked
+ * read-modify-write. Snapshot can be called from any other thread.
+ */
+class CircularBufferCounters {
+ public:
+  struct Counters {
+    uint64_t pushes;       // Elements pushed (including overwriting pushes)
+    uint64_t pops;         // Elements popped
+    uint64_t rejected;     // Elements not pushed because the buffer was full
+    uint64_t overwritten;  // Elements overwritten by PushForce
+    uint64_t clears;       // Calls to Clear
+    size_t peak_size;      // The largest Size() seen
+  };
+
+  CircularBufferCounters() = default;
+  CircularBufferCounters(const CircularBufferCounters& other) noexcept {
+    *this = other;
+  }
+  CircularBufferCounters& operator=(
+      const CircularBufferCounters& rhs) noexcept {
+    const Counters counters = rhs.Snapshot();
+    this->pushes_.store(counters.pushes, std::memory_order_relaxed);
+    this->pops_.store(counters.pops, std::memory_order_relaxed);
+    this->rejected_.store(counters.rejected, std::memory_order_relaxed);
+    this->overwritten_.store(counters.overwritten, std::memory_order_relaxed);
+    this->clears_.store(counters.clears, std::memory_order_relaxed);
+    this->peak_size_.store(counters.peak_size, std::memory_order_relaxed);
+    return *this;
+  }
+
+  /**
+   * @brief Get a copy of the counters. Can be called from any thread.
+   *
+   * Every counter is read atomically, but the counters are not read at the
+   * same instant, so they can be a few operations apart when the buffer is in
+   * use.
+   *
+   * @return Counters
+   */
+  Counters Snapshot() const {
+    return Counters{this->pushes_.load(std::memory_order_relaxed),
+                    this->pops_.load(std::memory_order_relaxed),
+                    this->rejected_.load(std::memory_order_relaxed),
+                    this->overwritten_.load(std::memory_order_relaxed),
+                    this->clears_.load(std::memory_order_relaxed),
+                    this->peak_size_.load(std::memory_order_relaxed)};
+  }
+
+ protected:
+  void on_push_(size_t count, size_t size) {
+    add_(this->pushes_, count);
+    if (size > this->peak_size_.load(std::memory_order_relaxed))
+      this->peak_size_.store(size, std::memory_order_relaxed);
+  }
+  void on_reject_(size_t count) { add_(this->rejected_, count); }
+  void on_overwrite_() { add_(this->overwritten_, 1); }
+  void on_pop_(size_t count) { add_(this->pops_, count); }
+  void on_clear_() { add_(this->clears_, 1); }
+
+ private:
+  /// @brief Add to a counter that only has one writer.
+  static void add_(std::atomic<uint64_t>& counter, uint64_t count) {
+    counter.store(counter.load(std::memory_order_relaxed) + count,
+                  std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> pushes_{0};
+  std::atomic<uint64_t> pops_{0};
+  std::atomic<uint64_t> rejected_{0};
+  std::atomic<uint64_t> overwritten_{0};
+  std::atomic<uint64_t> clears_{0};
+  std::atomic<size_t> peak_size_{0};
+};
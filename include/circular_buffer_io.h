@@ -0,0 +1,64 @@
+/**
+ * @file circular_buffer_io.h
+ * @author Wouter (wjtje)
+ * @brief Scatter/gather I/O between a file descriptor and a byte
+ * CircularBuffer (POSIX only)
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <array>
+#include <cstddef>
+
+#include "circular_buffer.h"
+
+/**
+ * @brief Read from fd straight into the free space of the buffer, with a
+ * single readv call over both free segments.
+ *
+ * @param buffer The buffer to append the bytes to
+ * @param fd The file descriptor to read from
+ * @return ssize_t The amount of bytes read, 0 at end of file, -1 on an error
+ * (errno is set to ENOBUFS when the buffer is full).
+ */
+template <typename T, size_t SIZE, typename Instrumentation>
+ssize_t ReadFrom(CircularBuffer<T, SIZE, Instrumentation>& buffer, int fd) {
+  static_assert(sizeof(T) == 1, "ReadFrom requires a byte buffer");
+  const auto segments = buffer.FreeSegments();
+  if (segments[0].Empty()) {
+    errno = ENOBUFS;
+    return -1;
+  }
+  const iovec iov[2] = {{segments[0].data, segments[0].size},
+                        {segments[1].data, segments[1].size}};
+  const ssize_t n = readv(fd, iov, segments[1].Empty() ? 1 : 2);
+  if (n > 0) buffer.WriteCommit(size_t(n));
+  return n;
+}
+
+/**
+ * @brief Write the contents of the buffer to fd, with a single writev call
+ * over both used segments. Only the bytes that were written are removed.
+ *
+ * @param buffer The buffer to take the bytes from
+ * @param fd The file descriptor to write to
+ * @return ssize_t The amount of bytes written (0 when the buffer is empty),
+ * -1 on an error.
+ */
+template <typename T, size_t SIZE, typename Instrumentation>
+ssize_t WriteTo(CircularBuffer<T, SIZE, Instrumentation>& buffer, int fd) {
+  static_assert(sizeof(T) == 1, "WriteTo requires a byte buffer");
+  const auto segments = buffer.Segments();
+  if (segments[0].Empty()) return 0;
+  const iovec iov[2] = {{segments[0].data, segments[0].size},
+                        {segments[1].data, segments[1].size}};
+  const ssize_t n = writev(fd, iov, segments[1].Empty() ? 1 : 2);
+  if (n > 0) buffer.ReadRelease(size_t(n));
+  return n;
+}
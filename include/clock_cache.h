@@ -0,0 +1,232 @@
+/**
+ * @file clock_cache.h
+ * @author Wouter (wjtje)
+ * @brief A fixed capacity cache with CLOCK (second chance) eviction
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief A key-value cache of at most CAPACITY entries that approximates LRU
+ * with the CLOCK algorithm.
+ *
+ * The entries form a ring that the clock hand moves over, like the slots of a
+ * CircularBuffer. A hit only sets the reference bit of the entry. When the
+ * cache is full the hand clears reference bits until it finds an entry
+ * without one, that entry is replaced. Entries never move, Erase puts the
+ * position of the entry on a free list that Put takes from first, so a
+ * pointer from Get stays valid until its own entry is evicted or erased.
+ *
+ * Keys are found through an open-addressing (linear probing) index of at
+ * least twice CAPACITY slots, entries are removed with backward-shift
+ * deletion so there are no tombstones. The hash is multiplied by 2^64 / phi
+ * and the top bits select the home slot, so keys that only differ in their
+ * high bits do not cluster. Everything is stored in the object,
+ * so nothing is allocated after construction. Get, Put and Erase are O(1)
+ * expected, the hand moves amortized O(1) per eviction.
+ *
+ * @tparam Key The type of the keys, must be default constructible
+ * @tparam Value The type of the values, must be default constructible
+ * @tparam CAPACITY The maximum amount of entries
+ * @tparam Hash The hash function for Key
+ */
+template <typename Key, typename Value, size_t CAPACITY,
+          typename Hash = std::hash<Key>>
+class ClockCache {
+  static_assert(CAPACITY > 0 && CAPACITY < UINT32_MAX,
+                "ClockCache requires a CAPACITY that fits in 32 bits");
+
+ public:
+  ClockCache() { this->Clear(); }
+
+  /**
+   * @brief Return the amount of entries in the cache.
+   *
+   * @return size_t
+   */
+  size_t Size() const { return this->size_; }
+  /**
+   * @brief Return the size (capacity) of the cache.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return CAPACITY; }
+  /**
+   * @brief Return true when the cache is empty
+   *
+   * @return true
+   * @return false
+   */
+  bool Empty() const { return this->size_ == 0; }
+  /**
+   * @brief Remove all entries.
+   */
+  void Clear() {
+    for (uint32_t& slot : this->index_) slot = kEmpty;
+    this->size_ = 0;
+    this->used_ = 0;
+    this->free_count_ = 0;
+    this->hand_ = 0;
+  }
+
+  /**
+   * @brief Look up a key and mark its entry as recently used.
+   *
+   * @param key
+   * @param value[out] Points to the cached value, valid until the entry of
+   * this key is evicted or erased (operations on other keys do not move it)
+   * @return int Returns 0 on a hit, -1 on a miss
+   */
+  int Get(const Key& key, Value** value) {
+    const size_t slot = this->find_(key, Hash()(key));
+    if (this->index_[slot] == kEmpty) return -1;
+    Entry& entry = this->entries_[this->index_[slot]];
+    entry.referenced = true;
+    *value = &entry.value;
+    return 0;
+  }
+  /**
+   * @brief Insert or update a key. When the cache is full an entry that was
+   * not used recently is evicted.
+   *
+   * @param key
+   * @param value[in]
+   * @return int Returns 0 when nothing was evicted, 1 when an entry was
+   * evicted to make room.
+   */
+  int Put(const Key& key, const Value& value) {
+    const size_t hash = Hash()(key);
+    size_t slot = this->find_(key, hash);
+    if (this->index_[slot] != kEmpty) {
+      Entry& entry = this->entries_[this->index_[slot]];
+      entry.value = value;
+      entry.referenced = true;
+      return 0;
+    }
+
+    int evicted = 0;
+    uint32_t position;
+    if (this->size_ < CAPACITY) {
+      // Reuse an erased entry first, then the ones that were never used
+      position = this->free_count_ > 0 ? this->free_[--(this->free_count_)]
+                                       : uint32_t(this->used_++);
+      ++(this->size_);
+    } else {
+      position = this->evict_();
+      evicted = 1;
+      // The eviction may have shifted the slot of the new key
+      slot = this->find_(key, hash);
+    }
+    Entry& entry = this->entries_[position];
+    entry.key = key;
+    entry.value = value;
+    entry.hash = hash;
+    entry.referenced = true;
+    this->index_[slot] = position;
+    return evicted;
+  }
+  /**
+   * @brief Remove a key from the cache.
+   *
+   * @param key
+   * @return int Returns 0 on success, -1 when the key is not cached
+   */
+  int Erase(const Key& key) {
+    const size_t slot = this->find_(key, Hash()(key));
+    if (this->index_[slot] == kEmpty) return -1;
+    const uint32_t position = this->index_[slot];
+    this->remove_slot_(slot);
+
+    // Release the key and value, the entry stays in place until Put reuses it
+    this->entries_[position] = Entry();
+    this->free_[this->free_count_++] = position;
+    --(this->size_);
+    return 0;
+  }
+
+ protected:
+  static constexpr uint32_t kEmpty = UINT32_MAX;
+  static constexpr size_t table_size_() {
+    size_t size = 1;
+    while (size < 2 * CAPACITY) size <<= 1;
+    return size;
+  }
+  static constexpr size_t kTableSize = table_size_();
+  static constexpr size_t kMask = kTableSize - 1;
+  static constexpr int kTableBits = __builtin_ctzll(kTableSize);
+
+  struct Entry {
+    Key key{};
+    Value value{};
+    size_t hash{0};
+    bool referenced{false};
+  };
+
+  /// @brief Return the first slot to probe for a hash. The hash is mixed
+  /// first (Fibonacci hashing), std::hash of an integer is often the integer
+  /// itself, and keys with the same low bits would all share a home slot.
+  static size_t home_(size_t hash) {
+    return size_t((uint64_t(hash) * 0x9e3779b97f4a7c15ull) >>
+                  (64 - kTableBits));
+  }
+  /// @brief Return the slot of key, or the empty slot where it would go.
+  size_t find_(const Key& key, size_t hash) const {
+    size_t slot = home_(hash);
+    while (this->index_[slot] != kEmpty) {
+      const Entry& entry = this->entries_[this->index_[slot]];
+      if (entry.hash == hash && entry.key == key) break;
+      slot = (slot + 1) & kMask;
+    }
+    return slot;
+  }
+  /// @brief Return the slot that refers to the entry at position.
+  size_t slot_of_(uint32_t position, size_t hash) const {
+    size_t slot = home_(hash);
+    while (this->index_[slot] != position) slot = (slot + 1) & kMask;
+    return slot;
+  }
+  /// @brief Empty a slot, shifting later entries of the probe run back so
+  /// every key stays reachable from its home slot.
+  void remove_slot_(size_t hole) {
+    size_t slot = hole;
+    for (;;) {
+      slot = (slot + 1) & kMask;
+      if (this->index_[slot] == kEmpty) break;
+      const size_t home = home_(this->entries_[this->index_[slot]].hash);
+      // Move the entry back unless its home is in (hole, slot]
+      if (((slot - home) & kMask) >= ((slot - hole) & kMask)) {
+        this->index_[hole] = this->index_[slot];
+        hole = slot;
+      }
+    }
+    this->index_[hole] = kEmpty;
+  }
+  /// @brief Advance the hand to an entry without reference bit, remove it
+  /// from the index and return its position. Only called when the cache is
+  /// full, so every entry the hand passes is in use.
+  uint32_t evict_() {
+    while (this->entries_[this->hand_].referenced) {
+      this->entries_[this->hand_].referenced = false;
+      if (++(this->hand_) == CAPACITY) this->hand_ = 0;
+    }
+    const uint32_t victim = uint32_t(this->hand_);
+    if (++(this->hand_) == CAPACITY) this->hand_ = 0;
+    this->remove_slot_(this->slot_of_(victim, this->entries_[victim].hash));
+    return victim;
+  }
+
+  Entry entries_[CAPACITY];
+  uint32_t index_[kTableSize];  // Entry positions
+  uint32_t free_[CAPACITY];     // Positions of erased entries
+  size_t free_count_{0};
+  size_t used_{0};  // Entries at and after used_ were never used
+  size_t size_{0};
+  size_t hand_{0};
+};
@@ -0,0 +1,649 @@
+/**
+ * @file dynamic_circular_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A circular buffer with a runtime capacity and a heap allocated buffer
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A circular buffer with the same API as CircularBuffer, but the
+ * capacity is set at construction and the buffer is allocated with Allocator.
+ *
+ * @tparam T The type of the elements
+ * @tparam Allocator The allocator used for the buffer
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class DynamicCircularBuffer {
+  using AllocTraits = std::allocator_traits<Allocator>;
+  static constexpr bool kPropagateOnCopy =
+      AllocTraits::propagate_on_container_copy_assignment::value;
+  static constexpr bool kPropagateOnMove =
+      AllocTraits::propagate_on_container_move_assignment::value;
+
+ public:
+  /**
+   * @brief A contiguous range of elements inside the buffer.
+   */
+  struct Span {
+    T* data;
+    size_t size;
+
+    T* begin() const { return data; }
+    T* end() const { return data + size; }
+    bool Empty() const { return size == 0; }
+  };
+
+  explicit DynamicCircularBuffer(size_t capacity,
+                                 const Allocator& allocator = Allocator())
+      : allocator_(allocator) {
+    this->allocate_(capacity);
+  }
+  DynamicCircularBuffer(const DynamicCircularBuffer& other)
+      : DynamicCircularBuffer(
+            other.capacity_,
+            AllocTraits::select_on_container_copy_construction(
+                other.allocator_)) {
+    other.for_each_index_([&](size_t i) { this->Emplace(other.buffer_[i]); });
+  }
+  DynamicCircularBuffer(DynamicCircularBuffer&& other) noexcept
+      : allocator_(std::move(other.allocator_)),
+        buffer_(std::exchange(other.buffer_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        head_(std::exchange(other.head_, 0)),
+        size_(std::exchange(other.size_, 0)) {}
+  DynamicCircularBuffer& operator=(const DynamicCircularBuffer& rhs) {
+    if (this == &rhs) return *this;
+    this->Clear();
+    bool reallocate = this->capacity_ != rhs.capacity_;
+    if constexpr (kPropagateOnCopy)
+      reallocate = reallocate || this->allocator_ != rhs.allocator_;
+    // The buffer is released with the allocator that allocated it
+    if (reallocate) this->deallocate_();
+    if constexpr (kPropagateOnCopy) this->allocator_ = rhs.allocator_;
+    if (reallocate) this->allocate_(rhs.capacity_);
+    rhs.for_each_index_([&](size_t i) { this->Emplace(rhs.buffer_[i]); });
+    return *this;
+  }
+  DynamicCircularBuffer& operator=(DynamicCircularBuffer&& rhs) noexcept(
+      kPropagateOnMove || AllocTraits::is_always_equal::value) {
+    if (this == &rhs) return *this;
+    this->Clear();
+    if constexpr (!kPropagateOnMove && !AllocTraits::is_always_equal::value) {
+      // Memory of another allocator can not be adopted, move the elements
+      if (this->allocator_ != rhs.allocator_) {
+        if (this->capacity_ != rhs.capacity_) {
+          this->deallocate_();
+          this->allocate_(rhs.capacity_);
+        }
+        rhs.for_each_index_(
+            [&](size_t i) { this->Emplace(std::move(rhs.buffer_[i])); });
+        rhs.Clear();
+        return *this;
+      }
+    }
+    this->deallocate_();
+    if constexpr (kPropagateOnMove)
+      this->allocator_ = std::move(rhs.allocator_);
+    this->buffer_ = std::exchange(rhs.buffer_, nullptr);
+    this->capacity_ = std::exchange(rhs.capacity_, 0);
+    this->head_ = std::exchange(rhs.head_, 0);
+    this->size_ = std::exchange(rhs.size_, 0);
+    return *this;
+  }
+  ~DynamicCircularBuffer() {
+    this->Clear();
+    this->deallocate_();
+  }
+
+  /**
+   * @brief Return true when the buffer is full.
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Full() const { return this->size_ == this->capacity_; }
+  /**
+   * @brief Return true when the buffer is empty
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Empty() const { return this->size_ == 0; }
+  /**
+   * @brief Remove (and destroy) all elements in the buffer.
+   */
+  void Clear() {
+    this->destroy_(this->head_, this->size_);
+    this->head_ = 0;
+    this->size_ = 0;
+  }
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline size_t MaxSize() const { return this->capacity_; }
+  /**
+   * @brief Return the amount of elements in the buffer, this is between 0 and
+   * size.
+   *
+   * @return size_t
+   */
+  inline size_t Size() const { return this->size_; }
+  /**
+   * @brief Grow the capacity of the buffer. The elements are moved to the new
+   * buffer in a single pass, starting at index 0.
+   *
+   * @param capacity The new capacity, nothing happens when this is not larger
+   * than the current capacity.
+   */
+  void Reserve(size_t capacity) {
+    if (capacity <= this->capacity_) return;
+    T* buffer = AllocTraits::allocate(this->allocator_, capacity);
+    const size_t first = std::min(this->size_, this->capacity_ - this->head_);
+    relocate_(buffer, &this->buffer_[this->head_], first);
+    relocate_(buffer + first, this->buffer_, this->size_ - first);
+    if (this->buffer_)
+      AllocTraits::deallocate(this->allocator_, this->buffer_,
+                              this->capacity_);
+    this->buffer_ = buffer;
+    this->capacity_ = capacity;
+    this->head_ = 0;
+  }
+  /**
+   * @brief Push data to the end of the buffer.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(const T& data) { return this->Emplace(data); }
+  /**
+   * @brief Move data to the end of the buffer.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(T&& data) { return this->Emplace(std::move(data)); }
+  /**
+   * @brief Construct an element in place at the end of the buffer.
+   *
+   * @param args[in] The arguments passed to the constructor of T
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  template <typename... Args>
+  int Emplace(Args&&... args) {
+    if (this->Full()) return -1;
+    AllocTraits::construct(this->allocator_, &this->buffer_[this->tail_()],
+                           std::forward<Args>(args)...);
+    ++(this->size_);
+    return 0;
+  }
+  /**
+   * @brief Push data to the end of the buffer, even if the buffer is full.
+   * When full the oldest element is destroyed and replaced.
+   *
+   * @param data[in]
+   */
+  void PushForce(const T& data) { this->push_force_(data); }
+  /**
+   * @brief Move data to the end of the buffer, even if the buffer is full.
+   * When full the oldest element is destroyed and replaced.
+   *
+   * @param data[in]
+   */
+  void PushForce(T&& data) { this->push_force_(std::move(data)); }
+  /**
+   * @brief Get the data that is at the front of the buffer. The element is
+   * moved out and removed from the buffer.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(T* data) {
+    if (this->Empty()) return -1;
+    *data = std::move(this->buffer_[this->head_]);
+    this->Pop();
+    return 0;
+  }
+  /**
+   * @brief Remove the data this is at the front of the buffer
+   *
+   * @return int Returns 0 on success, -1 when there is no data.
+   */
+  int Pop() {
+    if (this->Empty()) return -1;
+    AllocTraits::destroy(this->allocator_, &this->buffer_[this->head_]);
+    this->advance_head_(1);
+    return 0;
+  }
+  /**
+   * @brief Push up to count elements to the end of the buffer. The data is
+   * copied in at most two contiguous segments and the indices are updated
+   * once.
+   *
+   * @param data[in]
+   * @param count The amount of elements in data
+   * @return size_t The amount of elements pushed, this is less than count when
+   * the buffer ran out of space.
+   */
+  size_t PushN(const T* data, size_t count) {
+    const size_t n = std::min(count, this->capacity_ - this->size_);
+    if (n == 0) return 0;
+    const size_t tail = this->tail_();
+    const size_t first = std::min(n, this->capacity_ - tail);
+    this->copy_in_(&this->buffer_[tail], data, first);
+    this->copy_in_(this->buffer_, data + first, n - first);
+    this->size_ += n;
+    return n;
+  }
+  /**
+   * @brief Get up to count elements from the front of the buffer. The data is
+   * moved out in at most two contiguous segments and the indices are updated
+   * once.
+   *
+   * @param data[out]
+   * @param count The amount of elements that fit in data
+   * @return size_t The amount of elements popped, this is less than count when
+   * the buffer ran out of data.
+   */
+  size_t PopN(T* data, size_t count) {
+    const size_t n = std::min(count, this->size_);
+    if (n == 0) return 0;
+    const size_t first = std::min(n, this->capacity_ - this->head_);
+    this->move_out_(data, &this->buffer_[this->head_], first);
+    this->move_out_(data + first, this->buffer_, n - first);
+    this->advance_head_(n);
+    return n;
+  }
+  /**
+   * @brief Get direct access to the free space at the end of the buffer, so it
+   * can be written in place. Call WriteCommit to add the written elements to
+   * the buffer. Only available for trivially copyable types, because the free
+   * space holds no constructed objects.
+   *
+   * @param max The maximum amount of elements that will be written
+   * @return Span A contiguous writable range of at most max elements, this is
+   * empty when the buffer is full.
+   */
+  Span WriteAcquire(size_t max = SIZE_MAX) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WriteAcquire requires a trivially copyable T");
+    const size_t tail = this->tail_();
+    const size_t n =
+        std::min({max, this->capacity_ - this->size_, this->capacity_ - tail});
+    return Span{this->buffer_ + tail, n};
+  }
+  /**
+   * @brief Add count elements, written in place after WriteAcquire, to the end
+   * of the buffer.
+   *
+   * @param count The amount of elements written
+   * @return int Returns 0 on success, -1 when count exceeds the free space.
+   */
+  int WriteCommit(size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WriteCommit requires a trivially copyable T");
+    if (count > this->capacity_ - this->size_) return -1;
+    this->size_ += count;
+    return 0;
+  }
+  /**
+   * @brief Get direct access to the data at the front of the buffer, so it can
+   * be read in place. Call ReadRelease to remove the read elements from the
+   * buffer.
+   *
+   * @param max The maximum amount of elements that will be read
+   * @return Span A contiguous range of at most max elements, this is empty when
+   * the buffer is empty.
+   */
+  Span ReadAcquire(size_t max = SIZE_MAX) {
+    const size_t n =
+        std::min({max, this->size_, this->capacity_ - this->head_});
+    return Span{this->buffer_ + this->head_, n};
+  }
+  /**
+   * @brief Remove (and destroy) count elements, read in place after
+   * ReadAcquire, from the front of the buffer.
+   *
+   * @param count The amount of elements read
+   * @return int Returns 0 on success, -1 when count exceeds the amount of
+   * elements in the buffer.
+   */
+  int ReadRelease(size_t count) {
+    if (count > this->size_) return -1;
+    this->destroy_(this->head_, count);
+    this->advance_head_(count);
+    return 0;
+  }
+  /**
+   * @brief Direct pop.
+   * Get the data that is at the front of the buffer, without checking if there
+   * is any.
+   * @warning The buffer may not be empty.
+   *
+   * @return T The element that was at the front
+   */
+  T DirectPop() {
+    T d = std::move(this->buffer_[this->head_]);
+    AllocTraits::destroy(this->allocator_, &this->buffer_[this->head_]);
+    this->advance_head_(1);
+    return d;
+  }
+  /**
+   * @brief Get the data that in the front of the buffer, without removing it.
+   *
+   * @param data
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Peek(T** data) {
+    if (this->Empty()) return -1;
+    *data = &this->buffer_[this->head_];
+    return 0;
+  }
+  /**
+   * @brief Get access to the first item in the queue.
+   * @warning This item is invalid when the queue is empty.
+   *
+   * @return T&
+   */
+  T& Front() { return this->buffer_[this->head_]; }
+
+  /**
+   * @brief A random-access iterator over the elements, from front to back,
+   * like CircularBuffer::BasicIterator.
+   *
+   * @tparam CONST Iterate over const elements
+   */
+  template <bool CONST>
+  class BasicIterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<CONST, const T*, T*>;
+    using reference = std::conditional_t<CONST, const T&, T&>;
+
+    BasicIterator() = default;
+    BasicIterator(pointer buffer, size_t capacity, size_t head, size_t offset)
+        : buffer_(buffer), capacity_(capacity), head_(head), offset_(offset) {}
+    /// @brief A non-const iterator converts to a const iterator.
+    operator BasicIterator<true>() const {
+      return BasicIterator<true>(this->buffer_, this->capacity_, this->head_,
+                                 this->offset_);
+    }
+
+    reference operator*() const { return this->buffer_[this->index_()]; }
+    pointer operator->() const { return &this->buffer_[this->index_()]; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+    template <bool C = CONST, typename = std::enable_if_t<!C>>
+    T& operator=(const T& p) const {
+      return this->buffer_[this->index_()] = p;
+    }
+    /**
+     * @brief Get access to the pointer of the current item of the Iterator.
+     * This can be used to update an item that's already in the queue.
+     *
+     * @return reference
+     */
+    reference Get() const { return this->buffer_[this->index_()]; }
+
+    BasicIterator& operator++() {
+      ++(this->offset_);
+      return *this;
+    }
+    BasicIterator operator++(int) {
+      BasicIterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+    BasicIterator& operator--() {
+      --(this->offset_);
+      return *this;
+    }
+    BasicIterator operator--(int) {
+      BasicIterator tmp = *this;
+      --(*this);
+      return tmp;
+    }
+    BasicIterator& operator+=(difference_type n) {
+      this->offset_ += size_t(n);
+      return *this;
+    }
+    BasicIterator& operator-=(difference_type n) {
+      this->offset_ -= size_t(n);
+      return *this;
+    }
+    friend BasicIterator operator+(BasicIterator it, difference_type n) {
+      return it += n;
+    }
+    friend BasicIterator operator+(difference_type n, BasicIterator it) {
+      return it += n;
+    }
+    friend BasicIterator operator-(BasicIterator it, difference_type n) {
+      return it -= n;
+    }
+    friend difference_type operator-(const BasicIterator& a,
+                                     const BasicIterator& b) {
+      return difference_type(a.offset_ - b.offset_);
+    }
+
+    friend bool operator==(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ == b.offset_;
+    }
+    friend bool operator!=(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ != b.offset_;
+    }
+    friend bool operator<(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ < b.offset_;
+    }
+    friend bool operator>(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ > b.offset_;
+    }
+    friend bool operator<=(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ <= b.offset_;
+    }
+    friend bool operator>=(const BasicIterator& a, const BasicIterator& b) {
+      return a.offset_ >= b.offset_;
+    }
+
+   private:
+    size_t index_() const {
+      const size_t index = this->head_ + this->offset_;
+      return index >= this->capacity_ ? index - this->capacity_ : index;
+    }
+
+    pointer buffer_{nullptr};
+    size_t capacity_{0};
+    size_t head_{0};    // Index of the front of the buffer
+    size_t offset_{0};  // Offset from the front, between 0 and Size()
+  };
+
+  using Iterator = BasicIterator<false>;
+  using ConstIterator = BasicIterator<true>;
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+  Iterator begin() {
+    return Iterator(this->buffer_, this->capacity_, this->head_, 0);
+  }
+  Iterator end() {
+    return Iterator(this->buffer_, this->capacity_, this->head_, this->size_);
+  }
+  ConstIterator begin() const {
+    return ConstIterator(this->buffer_, this->capacity_, this->head_, 0);
+  }
+  ConstIterator end() const {
+    return ConstIterator(this->buffer_, this->capacity_, this->head_,
+                         this->size_);
+  }
+  ConstIterator cbegin() const { return this->begin(); }
+  ConstIterator cend() const { return this->end(); }
+
+  /**
+   * @brief Get access to the element at index, counted from the front.
+   * @warning index must be smaller than Size().
+   *
+   * @param index
+   * @return T&
+   */
+  T& operator[](size_t index) {
+    return this->buffer_[this->wrap_(this->head_ + index)];
+  }
+  const T& operator[](size_t index) const {
+    return this->buffer_[this->wrap_(this->head_ + index)];
+  }
+  /**
+   * @brief Get the element at index, counted from the front.
+   *
+   * @param index
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when index is out of range
+   */
+  int At(size_t index, T** data) {
+    if (index >= this->size_) return -1;
+    *data = &(*this)[index];
+    return 0;
+  }
+  /**
+   * @brief Get the elements as (at most) two contiguous ranges, from front to
+   * back. The second range is empty when the elements do not wrap around.
+   *
+   * @return std::array<Span, 2>
+   */
+  std::array<Span, 2> Segments() {
+    const size_t first = std::min(this->size_, this->capacity_ - this->head_);
+    return {Span{this->buffer_ + this->head_, first},
+            Span{this->buffer_, this->size_ - first}};
+  }
+  /**
+   * @brief Get the free space as (at most) two contiguous ranges, from the end
+   * of the buffer onwards. Write to them and call WriteCommit, like
+   * WriteAcquire but without stopping at the end of the allocation. Only
+   * available for trivially copyable types.
+   *
+   * @return std::array<Span, 2>
+   */
+  std::array<Span, 2> FreeSegments() {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "FreeSegments requires a trivially copyable T");
+    const size_t tail = this->tail_();
+    const size_t free = this->capacity_ - this->size_;
+    const size_t first = std::min(free, this->capacity_ - tail);
+    return {Span{this->buffer_ + tail, first},
+            Span{this->buffer_, free - first}};
+  }
+
+ protected:
+  Allocator allocator_;
+  T* buffer_{nullptr};
+  size_t capacity_{0};
+  size_t head_{0}, size_{0};
+
+  size_t wrap_(size_t index) const {
+    return index >= this->capacity_ ? index - this->capacity_ : index;
+  }
+  size_t tail_() const { return this->wrap_(this->head_ + this->size_); }
+  void advance_head_(size_t count) {
+    this->head_ = this->wrap_(this->head_ + count);
+    this->size_ -= count;
+  }
+
+  template <typename U>
+  void push_force_(U&& data) {
+    if (this->capacity_ == 0) return;
+    if (this->Full()) {
+      T* front = &this->buffer_[this->head_];
+      // The oldest element is in the slot, pushing it again only rotates
+      if (static_cast<const void*>(std::addressof(data)) == front) {
+        this->head_ = this->wrap_(this->head_ + 1);
+        return;
+      }
+      AllocTraits::destroy(this->allocator_, front);
+      // Drop it first, so a throwing constructor leaves a valid buffer
+      this->advance_head_(1);
+    }
+    this->Emplace(std::forward<U>(data));
+  }
+  /// @brief Allocate an empty buffer of capacity elements.
+  void allocate_(size_t capacity) {
+    if (capacity > 0)
+      this->buffer_ = AllocTraits::allocate(this->allocator_, capacity);
+    this->capacity_ = capacity;
+  }
+  /// @brief Release the buffer, it must be empty.
+  void deallocate_() {
+    if (this->buffer_)
+      AllocTraits::deallocate(this->allocator_, this->buffer_,
+                              this->capacity_);
+    this->buffer_ = nullptr;
+    this->capacity_ = 0;
+  }
+  /// @brief Call f with the index of every element, from front to back.
+  template <typename F>
+  void for_each_index_(F f) const {
+    size_t index = this->head_;
+    for (size_t i = this->size_; i > 0; --i) {
+      f(index);
+      if (++index == this->capacity_) index = 0;
+    }
+  }
+  /// @brief Destroy count elements, starting at index and wrapping around.
+  void destroy_(size_t index, size_t count) {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (; count > 0; --count) {
+        AllocTraits::destroy(this->allocator_, &this->buffer_[index]);
+        if (++index == this->capacity_) index = 0;
+      }
+    }
+  }
+  /// @brief Construct count elements in uninitialized storage from src.
+  void copy_in_(T* dst, const T* src, size_t count) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (count) std::memcpy(dst, src, count * sizeof(T));
+    } else {
+      for (size_t i = 0; i < count; ++i)
+        AllocTraits::construct(this->allocator_, dst + i, src[i]);
+    }
+  }
+  /// @brief Move count elements out of the buffer and destroy them.
+  void move_out_(T* dst, T* src, size_t count) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (count) std::memcpy(dst, src, count * sizeof(T));
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        dst[i] = std::move(src[i]);
+        AllocTraits::destroy(this->allocator_, src + i);
+      }
+    }
+  }
+  /// @brief Move count elements into uninitialized storage and destroy them.
+  void relocate_(T* dst, T* src, size_t count) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (count) std::memcpy(dst, src, count * sizeof(T));
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        AllocTraits::construct(this->allocator_, dst + i, std::move(src[i]));
+        AllocTraits::destroy(this->allocator_, src + i);
+      }
+    }
+  }
+};
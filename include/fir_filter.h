@@ -0,0 +1,177 @@
+/**
+ * @file fir_filter.h
+ * @author Wouter (wjtje)
+ * @brief A block based FIR filter with SSE and AVX2 kernels
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define FIR_FILTER_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FIR_FILTER_SSE 1
+#endif
+
+#include "circular_buffer.h"
+
+/**
+ * @brief A finite impulse response filter, y[n] = sum(h[k] * x[n - k]), that
+ * processes the input in blocks of up to BLOCK samples.
+ *
+ * The taps are stored reversed and the history is kept in a linear buffer in
+ * front of the current block, so the window of every output sample is
+ * contiguous. The kernel computes 8 (AVX2) or 4 (SSE) neighbouring outputs at
+ * once: one broadcast tap is multiplied with an unaligned load of the
+ * samples. The kernel is selected at compile time (compile with -mavx2 -mfma
+ * to get the AVX2 kernel), there is a scalar fallback for other targets.
+ *
+ * A moving average is a filter with TAPS taps of 1 / TAPS.
+ *
+ * @tparam TAPS The amount of taps
+ * @tparam BLOCK The maximum amount of samples processed at once
+ */
+template <size_t TAPS, size_t BLOCK = 256>
+class FirFilter {
+  static_assert(TAPS > 0 && BLOCK > 0, "FirFilter requires taps and a block");
+
+ public:
+  /**
+   * @brief Construct a new filter with empty (zero) history.
+   *
+   * @param taps[in] TAPS coefficients, h[0] applies to the newest sample
+   */
+  explicit FirFilter(const float* taps) {
+    for (size_t k = 0; k < TAPS; ++k) this->taps_[k] = taps[TAPS - 1 - k];
+    this->Reset();
+  }
+
+  /**
+   * @brief Clear the history, as if only zeros were filtered.
+   */
+  void Reset() { std::fill(this->samples_, this->samples_ + kHistory, 0.0f); }
+  /**
+   * @brief Return the amount of taps.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t Taps() const { return TAPS; }
+
+  /**
+   * @brief Filter count samples. Input and output may be the same array.
+   * Every block of up to BLOCK samples is copied behind the history first.
+   *
+   * @param input[in]
+   * @param output[out] Room for count samples
+   * @param count
+   */
+  void Process(const float* input, float* output, size_t count) {
+    while (count > 0) {
+      const size_t n = std::min(count, BLOCK);
+      std::memcpy(&this->samples_[kHistory], input, n * sizeof(float));
+      filter_(this->taps_, this->samples_, output, n);
+      // Keep the newest TAPS - 1 samples as history for the next block
+      std::memmove(this->samples_, &this->samples_[n],
+                   kHistory * sizeof(float));
+      input += n;
+      output += n;
+      count -= n;
+    }
+  }
+  /**
+   * @brief Filter (and pop) up to max samples from the front of a buffer.
+   * The buffer is read through ReadAcquire in at most two contiguous segments,
+   * every block is still copied into the history array of the filter.
+   *
+   * @param input The buffer with the samples
+   * @param output[out] Room for max samples
+   * @param max
+   * @return size_t The amount of samples filtered
+   */
+  template <size_t SIZE, typename Instrumentation>
+  size_t Process(CircularBuffer<float, SIZE, Instrumentation>& input,
+                 float* output, size_t max) {
+    size_t done = 0;
+    while (done < max) {
+      const auto span = input.ReadAcquire(max - done);
+      if (span.Empty()) break;
+      this->Process(span.data, output + done, span.size);
+      input.ReadRelease(span.size);
+      done += span.size;
+    }
+    return done;
+  }
+
+ protected:
+  static constexpr size_t kHistory = TAPS - 1;
+
+  /// @brief Compute count outputs, output i uses samples[i, i + TAPS).
+  static void filter_(const float* taps, const float* samples, float* output,
+                      size_t count) {
+    size_t i = 0;
+#if defined(FIR_FILTER_AVX2)
+    for (; i + 32 <= count; i += 32) {
+      __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+      __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+      const float* s = &samples[i];
+      for (size_t k = 0; k < TAPS; ++k) {
+        const __m256 h = _mm256_broadcast_ss(&taps[k]);
+        acc0 = _mm256_fmadd_ps(h, _mm256_loadu_ps(s + k), acc0);
+        acc1 = _mm256_fmadd_ps(h, _mm256_loadu_ps(s + k + 8), acc1);
+        acc2 = _mm256_fmadd_ps(h, _mm256_loadu_ps(s + k + 16), acc2);
+        acc3 = _mm256_fmadd_ps(h, _mm256_loadu_ps(s + k + 24), acc3);
+      }
+      _mm256_storeu_ps(&output[i], acc0);
+      _mm256_storeu_ps(&output[i + 8], acc1);
+      _mm256_storeu_ps(&output[i + 16], acc2);
+      _mm256_storeu_ps(&output[i + 24], acc3);
+    }
+    for (; i + 8 <= count; i += 8) {
+      __m256 acc = _mm256_setzero_ps();
+      for (size_t k = 0; k < TAPS; ++k)
+        acc = _mm256_fmadd_ps(_mm256_broadcast_ss(&taps[k]),
+                              _mm256_loadu_ps(&samples[i + k]), acc);
+      _mm256_storeu_ps(&output[i], acc);
+    }
+#elif defined(FIR_FILTER_SSE)
+    for (; i + 16 <= count; i += 16) {
+      __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+      __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+      const float* s = &samples[i];
+      for (size_t k = 0; k < TAPS; ++k) {
+        const __m128 h = _mm_set1_ps(taps[k]);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(h, _mm_loadu_ps(s + k)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(h, _mm_loadu_ps(s + k + 4)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(h, _mm_loadu_ps(s + k + 8)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(h, _mm_loadu_ps(s + k + 12)));
+      }
+      _mm_storeu_ps(&output[i], acc0);
+      _mm_storeu_ps(&output[i + 4], acc1);
+      _mm_storeu_ps(&output[i + 8], acc2);
+      _mm_storeu_ps(&output[i + 12], acc3);
+    }
+    for (; i + 4 <= count; i += 4) {
+      __m128 acc = _mm_setzero_ps();
+      for (size_t k = 0; k < TAPS; ++k)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[k]),
+                                         _mm_loadu_ps(&samples[i + k])));
+      _mm_storeu_ps(&output[i], acc);
+    }
+#endif
+    for (; i < count; ++i) {
+      float acc = 0;
+      for (size_t k = 0; k < TAPS; ++k) acc += taps[k] * samples[i + k];
+      output[i] = acc;
+    }
+  }
+
+  alignas(32) float taps_[TAPS];                // Reversed
+  alignas(32) float samples_[kHistory + BLOCK];  // History + current block
+};
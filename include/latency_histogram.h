@@ -0,0 +1,129 @@
+/**
+ * @file latency_histogram.h
+ * @author Wouter (wjtje)
+ * @brief A log-linear (HDR style) histogram for latencies
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief A histogram of uint64_t values with a fixed relative precision.
+ *
+ * Values below kSubBuckets have a bucket each. Above that every power of two
+ * is split into kSubBuckets / 2 linear buckets, so a bucket is never wider
+ * than 1 / 32 of its values (about 3%) and the whole uint64_t range fits in
+ * kBuckets counters.
+ *
+ * Record is called from one thread, Count, Max and Percentile can be called
+ * from any thread while it is recording. A copy reads every counter
+ * atomically, like Percentile.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 6;
+  static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+  static constexpr size_t kBuckets =
+      kSubBuckets + (64 - kSubBucketBits) * (kSubBuckets / 2);
+
+  LatencyHistogram() = default;
+  LatencyHistogram(const LatencyHistogram& other) noexcept { *this = other; }
+  LatencyHistogram& operator=(const LatencyHistogram& rhs) noexcept {
+    for (size_t i = 0; i < kBuckets; ++i)
+      this->counts_[i].store(rhs.counts_[i].load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+    this->count_.store(rhs.Count(), std::memory_order_relaxed);
+    this->max_.store(rhs.Max(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  /**
+   * @brief Add a value to the histogram. May only be called from one thread.
+   *
+   * @param value
+   */
+  void Record(uint64_t value) {
+    add_(this->counts_[bucket_(value)], 1);
+    add_(this->count_, 1);
+    if (value > this->max_.load(std::memory_order_relaxed))
+      this->max_.store(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Return the amount of recorded values.
+   *
+   * @return uint64_t
+   */
+  uint64_t Count() const {
+    return this->count_.load(std::memory_order_relaxed);
+  }
+  /**
+   * @brief Return the largest recorded value, 0 when empty.
+   *
+   * @return uint64_t
+   */
+  uint64_t Max() const { return this->max_.load(std::memory_order_relaxed); }
+  /**
+   * @brief Return the value below which a fraction q of the recorded values
+   * fall, for example 0.99 for p99. The result is the upper bound of its
+   * bucket, so it is at most about 3% too high.
+   *
+   * @param q The quantile, between 0 and 1
+   * @return uint64_t The value, 0 when empty
+   */
+  uint64_t Percentile(double q) const {
+    // Count the buckets themselves, Count() may be a bit ahead of them
+    uint64_t total = 0;
+    for (const std::atomic<uint64_t>& count : this->counts_)
+      total += count.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    uint64_t target = uint64_t(q * double(total) + 0.5);
+    if (target == 0) target = 1;
+    if (target > total) target = total;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += this->counts_[i].load(std::memory_order_relaxed);
+      if (seen >= target) {
+        const uint64_t upper = highest_(i);
+        const uint64_t max = this->Max();
+        return upper < max ? upper : max;
+      }
+    }
+    return this->Max();
+  }
+
+ protected:
+  static size_t bucket_(uint64_t value) {
+    if (value < kSubBuckets) return size_t(value);
+    const int exponent = 63 - __builtin_clzll(value);
+    const int shift = exponent - kSubBucketBits + 1;
+    // The top kSubBucketBits bits, the highest one is always set
+    const size_t top = size_t(value >> shift);
+    return kSubBuckets + size_t(shift - 1) * (kSubBuckets / 2) +
+           (top - kSubBuckets / 2);
+  }
+  /// @brief Return the highest value that falls in a bucket.
+  static uint64_t highest_(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    const size_t index = bucket - kSubBuckets;
+    const int shift = int(index / (kSubBuckets / 2)) + 1;
+    const uint64_t top = index % (kSubBuckets / 2) + kSubBuckets / 2;
+    return ((top + 1) << shift) - 1;
+  }
+  /// @brief Add to a counter that only has one writer.
+  static void add_(std::atomic<uint64_t>& counter, uint64_t count) {
+    counter.store(counter.load(std::memory_order_relaxed) + count,
+                  std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> counts_[kBuckets] = {};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> max_{0};
+};
@@ -0,0 +1,324 @@
+/**
+ * @file mirrored_ring_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A circular buffer that is mapped twice in virtual memory, so the
+ * contents are always contiguous (Linux only)
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A circular buffer where the same memfd pages are mapped twice, back
+ * to back. Element i and element i + MaxSize() share the same memory, so any
+ * window of up to MaxSize() elements starting inside the buffer is contiguous.
+ *
+ * Because of this the contents (and the free space) can always be handed out
+ * as a single pointer and length, and the Iterator is a plain pointer.
+ *
+ * The capacity is rounded up so the buffer is a whole number of pages. Call
+ * Init before using the buffer. The buffer can be moved, which transfers the
+ * mapping, but not copied.
+ *
+ * @tparam T The type of the elements, must be trivially copyable
+ */
+template <typename T>
+class MirroredRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "MirroredRingBuffer requires a trivially copyable T");
+
+ public:
+  /**
+   * @brief A contiguous range of elements inside the buffer.
+   */
+  struct Span {
+    T* data;
+    size_t size;
+
+    T* begin() const { return data; }
+    T* end() const { return data + size; }
+    bool Empty() const { return size == 0; }
+  };
+  using Iterator = T*;
+
+  MirroredRingBuffer() = default;
+  MirroredRingBuffer(const MirroredRingBuffer&) = delete;
+  MirroredRingBuffer& operator=(const MirroredRingBuffer&) = delete;
+  MirroredRingBuffer(MirroredRingBuffer&& other) noexcept
+      : buffer_(std::exchange(other.buffer_, nullptr)),
+        bytes_(std::exchange(other.bytes_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        head_(std::exchange(other.head_, 0)),
+        size_(std::exchange(other.size_, 0)) {}
+  MirroredRingBuffer& operator=(MirroredRingBuffer&& rhs) noexcept {
+    if (this != &rhs) {
+      this->release_();
+      this->buffer_ = std::exchange(rhs.buffer_, nullptr);
+      this->bytes_ = std::exchange(rhs.bytes_, 0);
+      this->capacity_ = std::exchange(rhs.capacity_, 0);
+      this->head_ = std::exchange(rhs.head_, 0);
+      this->size_ = std::exchange(rhs.size_, 0);
+    }
+    return *this;
+  }
+  ~MirroredRingBuffer() { this->release_(); }
+
+  /**
+   * @brief Create the double mapping.
+   *
+   * @param min_capacity The minimum amount of elements, this is rounded up to
+   * a whole number of pages.
+   * @return int Returns 0 on success, -1 when the mapping failed.
+   */
+  int Init(size_t min_capacity) {
+    this->release_();
+
+    const size_t page = size_t(sysconf(_SC_PAGESIZE));
+    size_t bytes = std::max<size_t>(min_capacity, 1) * sizeof(T);
+    bytes = (bytes + page - 1) / page * page;
+    while (bytes % sizeof(T) != 0) bytes += page;
+
+    const int fd = memfd_create("mirrored_ring_buffer", MFD_CLOEXEC);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, off_t(bytes)) != 0) {
+      close(fd);
+      return -1;
+    }
+
+    // Reserve the address space for both mappings, then map the file twice
+    void* base = mmap(nullptr, 2 * bytes, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+      close(fd);
+      return -1;
+    }
+    unsigned char* addr = static_cast<unsigned char*>(base);
+    if (mmap(addr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+             0) == MAP_FAILED ||
+        mmap(addr + bytes, bytes, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      munmap(base, 2 * bytes);
+      close(fd);
+      return -1;
+    }
+    close(fd);
+
+    this->buffer_ = reinterpret_cast<T*>(addr);
+    this->bytes_ = bytes;
+    this->capacity_ = bytes / sizeof(T);
+    this->head_ = 0;
+    this->size_ = 0;
+    return 0;
+  }
+
+  /**
+   * @brief Return true when the buffer is full.
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Full() const { return this->size_ == this->capacity_; }
+  /**
+   * @brief Return true when the buffer is empty
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Empty() const { return this->size_ == 0; }
+  void Clear() {
+    this->head_ = 0;
+    this->size_ = 0;
+  }
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline size_t MaxSize() const { return this->capacity_; }
+  /**
+   * @brief Return the amount of elements in the buffer, this is between 0 and
+   * size.
+   *
+   * @return size_t
+   */
+  inline size_t Size() const { return this->size_; }
+  /**
+   * @brief Push data to the end of the buffer.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(const T& data) {
+    if (this->Full()) return -1;
+    this->buffer_[this->wrap_(this->head_ + this->size_)] = data;
+    ++(this->size_);
+    return 0;
+  }
+  /**
+   * @brief Push data to the end of the buffer, even if the buffer is full.
+   * Does nothing before Init.
+   *
+   * @param data[in]
+   */
+  void PushForce(const T& data) {
+    if (this->capacity_ == 0) return;
+    this->buffer_[this->wrap_(this->head_ + this->size_)] = data;
+    if (this->Full())
+      this->head_ = this->wrap_(this->head_ + 1);
+    else
+      ++(this->size_);
+  }
+  /**
+   * @brief Get the data that is at the front of the buffer
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(T* data) {
+    if (this->Empty()) return -1;
+    *data = this->buffer_[this->head_];
+    this->advance_head_(1);
+    return 0;
+  }
+  /**
+   * @brief Remove the data this is at the front of the buffer
+   *
+   * @return int Returns 0 on success, -1 when there is no data.
+   */
+  int Pop() {
+    if (this->Empty()) return -1;
+    this->advance_head_(1);
+    return 0;
+  }
+  /**
+   * @brief Push up to count elements to the end of the buffer with a single
+   * copy.
+   *
+   * @param data[in]
+   * @param count The amount of elements in data
+   * @return size_t The amount of elements pushed
+   */
+  size_t PushN(const T* data, size_t count) {
+    Span span = this->WriteAcquire(count);
+    if (span.size) std::memcpy(span.data, data, span.size * sizeof(T));
+    this->WriteCommit(span.size);
+    return span.size;
+  }
+  /**
+   * @brief Get up to count elements from the front of the buffer with a single
+   * copy.
+   *
+   * @param data[out]
+   * @param count The amount of elements that fit in data
+   * @return size_t The amount of elements popped
+   */
+  size_t PopN(T* data, size_t count) {
+    Span span = this->ReadAcquire(count);
+    if (span.size) std::memcpy(data, span.data, span.size * sizeof(T));
+    this->advance_head_(span.size);
+    return span.size;
+  }
+  /**
+   * @brief Get direct access to all free space in the buffer, which is always
+   * contiguous. Call WriteCommit to add the written elements to the buffer.
+   *
+   * @param max The maximum amount of elements that will be written
+   * @return Span
+   */
+  Span WriteAcquire(size_t max = SIZE_MAX) {
+    return Span{this->buffer_ + this->head_ + this->size_,
+                std::min(max, this->capacity_ - this->size_)};
+  }
+  /**
+   * @brief Add count elements, written in place after WriteAcquire, to the end
+   * of the buffer.
+   *
+   * @param count The amount of elements written
+   * @return int Returns 0 on success, -1 when count exceeds the free space.
+   */
+  int WriteCommit(size_t count) {
+    if (count > this->capacity_ - this->size_) return -1;
+    this->size_ += count;
+    // The write may have gone through the mirror, make sure the compiler does
+    // not keep an old value of the same memory seen through the other mapping.
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    return 0;
+  }
+  /**
+   * @brief Get direct access to the contents of the buffer, which are always
+   * contiguous. Call ReadRelease to remove the read elements from the buffer.
+   *
+   * @param max The maximum amount of elements that will be read
+   * @return Span
+   */
+  Span ReadAcquire(size_t max = SIZE_MAX) {
+    return Span{this->buffer_ + this->head_, std::min(max, this->size_)};
+  }
+  /**
+   * @brief Remove count elements from the front of the buffer.
+   *
+   * @param count The amount of elements read
+   * @return int Returns 0 on success, -1 when count exceeds the amount of
+   * elements in the buffer.
+   */
+  int ReadRelease(size_t count) {
+    if (count > this->size_) return -1;
+    this->advance_head_(count);
+    return 0;
+  }
+  /**
+   * @brief Get the data that in the front of the buffer, without removing it.
+   *
+   * @param data
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Peek(T** data) {
+    if (this->Empty()) return -1;
+    *data = this->buffer_ + this->head_;
+    return 0;
+  }
+  /**
+   * @brief Get access to the first item in the queue.
+   * @warning This item is invalid when the queue is empty.
+   *
+   * @return T&
+   */
+  T& Front() { return this->buffer_[this->head_]; }
+
+  Iterator begin() { return this->buffer_ + this->head_; }
+  Iterator end() { return this->buffer_ + this->head_ + this->size_; }
+
+ protected:
+  T* buffer_{nullptr};
+  size_t bytes_{0};
+  size_t capacity_{0};
+  size_t head_{0}, size_{0};
+
+  size_t wrap_(size_t index) const {
+    return index >= this->capacity_ ? index - this->capacity_ : index;
+  }
+  void advance_head_(size_t count) {
+    this->head_ = this->wrap_(this->head_ + count);
+    this->size_ -= count;
+  }
+  void release_() {
+    if (this->buffer_) munmap(this->buffer_, 2 * this->bytes_);
+    this->buffer_ = nullptr;
+    this->bytes_ = 0;
+    this->capacity_ = 0;
+    this->head_ = 0;
+    this->size_ = 0;
+  }
+};
@@ -0,0 +1,132 @@
+/**
+ * @file mpmc_queue.h
+ * @author Wouter (wjtje)
+ * @brief A bounded lock-free multi-producer/multi-consumer queue
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief A bounded multi-producer/multi-consumer queue using a static buffer.
+ *
+ * Every slot carries a sequence number (Dmitry Vyukov's bounded MPMC queue).
+ * A producer claims a position by a CAS on the tail and then only touches its
+ * own slot, a consumer does the same on the head. Producers and consumers
+ * therefore never share a lock, and only contend with each other when they
+ * work on the same slot.
+ *
+ * @tparam T The type of the static buffer
+ * @tparam SIZE The length of the buffer
+ */
+template <typename T, size_t SIZE>
+class MpmcQueue {
+  static_assert(SIZE > 0, "MpmcQueue requires a non-zero SIZE");
+
+ public:
+  static constexpr size_t kCacheLineSize = 64;
+
+  MpmcQueue() {
+    for (size_t i = 0; i < SIZE; ++i)
+      this->buffer_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  /**
+   * @brief Return the size (capacity) of the queue.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+  /**
+   * @brief Return the approximate amount of elements in the queue, this is
+   * between 0 and size.
+   *
+   * @return size_t
+   */
+  size_t Size() const {
+    const size_t head = this->head_.load(std::memory_order_acquire);
+    const size_t tail = this->tail_.load(std::memory_order_acquire);
+    if (tail <= head) return 0;
+    return (tail - head) > SIZE ? SIZE : tail - head;
+  }
+  /**
+   * @brief Return true when the queue is (approximately) empty.
+   *
+   * @return true
+   * @return false
+   */
+  bool Empty() const { return this->Size() == 0; }
+  /**
+   * @brief Push data to the end of the queue, without waiting.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int TryPush(const T& data) {
+    size_t pos = this->tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = this->buffer_[pos % SIZE];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const ptrdiff_t diff = ptrdiff_t(sequence) - ptrdiff_t(pos);
+      if (diff == 0) {
+        // The slot is free, try to claim the position
+        if (this->tail_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          slot.data = data;
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return 0;
+        }
+      } else if (diff < 0) {
+        // The slot still holds data from the previous lap
+        return -1;
+      } else {
+        pos = this->tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  /**
+   * @brief Get the data that is at the front of the queue, without waiting.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int TryPop(T* data) {
+    size_t pos = this->head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = this->buffer_[pos % SIZE];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const ptrdiff_t diff = ptrdiff_t(sequence) - ptrdiff_t(pos + 1);
+      if (diff == 0) {
+        // The slot holds data, try to claim the position
+        if (this->head_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          *data = slot.data;
+          slot.sequence.store(pos + SIZE, std::memory_order_release);
+          return 0;
+        }
+      } else if (diff < 0) {
+        // The slot has not been written yet
+        return -1;
+      } else {
+        pos = this->head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+ protected:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  Slot buffer_[SIZE];
+
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+};
@@ -0,0 +1,354 @@
+/**
+ * @file persistent_ring_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A circular buffer stored in a memory mapped file, so the contents
+ * survive a crash of the process
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief A circular buffer (a journal) whose header and slots live in an
+ * mmap'ed file.
+ *
+ * The header (head, tail, full plus a checksum) is written to one of two
+ * copies in turn, so a crash during a header update always leaves the other,
+ * older, copy intact. Every record also carries its push sequence number and a
+ * checksum. On Open the newest valid header is selected and the newest and
+ * oldest records are validated. Recovery is O(1) after a clean shutdown or a
+ * crash of the process, and O(SIZE) in the worst case, when the OS crashed
+ * before torn records were synced and they have to be dropped one by one.
+ *
+ * When the buffer is full, PushForce first commits a header without the
+ * oldest record and only then overwrites its slot. A crash in between loses
+ * that record one push early, but never reorders the contents.
+ *
+ * Data written to the mapping survives a crash of the process without any
+ * syscall. To also survive a crash of the OS, call Sync or set a sync interval
+ * so msync is batched over several appends.
+ *
+ * @tparam T The type of the elements, must be trivially copyable
+ * @tparam SIZE The length of the buffer
+ */
+template <typename T, size_t SIZE>
+class PersistentRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "PersistentRingBuffer requires a trivially copyable T");
+  static_assert(SIZE > 0, "PersistentRingBuffer requires a non-zero SIZE");
+
+ public:
+  static constexpr uint32_t kMagic = 0x31425250;  // "PRB1"
+  static constexpr uint32_t kVersion = 1;
+
+  PersistentRingBuffer() = default;
+  PersistentRingBuffer(const PersistentRingBuffer&) = delete;
+  PersistentRingBuffer& operator=(const PersistentRingBuffer&) = delete;
+  ~PersistentRingBuffer() { this->Close(); }
+
+  /**
+   * @brief Open (or create) the journal file and recover its contents.
+   *
+   * @param path The path of the file
+   * @return int Returns 0 on success, -1 when the file could not be opened,
+   * has a different layout or has no valid header.
+   */
+  int Open(const char* path) {
+    this->Close();
+
+    const int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return -1;
+    }
+    const bool created = (st.st_size == 0);
+    if (created && ftruncate(fd, off_t(sizeof(File))) != 0) {
+      close(fd);
+      return -1;
+    }
+    if (!created && size_t(st.st_size) != sizeof(File)) {
+      close(fd);
+      return -1;
+    }
+    void* addr = mmap(nullptr, sizeof(File), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return -1;
+    this->file_ = static_cast<File*>(addr);
+
+    if (created) {
+      this->state_ = Header{};
+      this->commit_();
+      this->commit_();  // Initialize both copies
+      return 0;
+    }
+    if (this->recover_() != 0) {
+      this->Close();
+      return -1;
+    }
+    return 0;
+  }
+  /**
+   * @brief Sync and unmap the file.
+   */
+  void Close() {
+    if (!this->file_) return;
+    this->Sync();
+    munmap(this->file_, sizeof(File));
+    this->file_ = nullptr;
+  }
+  /**
+   * @brief Write all changes to the storage device.
+   *
+   * @return int Returns 0 on success, -1 when msync failed.
+   */
+  int Sync() {
+    this->unsynced_ = 0;
+    if (!this->file_) return -1;
+    return msync(this->file_, sizeof(File), MS_SYNC) == 0 ? 0 : -1;
+  }
+  /**
+   * @brief Call Sync automatically after every interval changes, 0 (the
+   * default) disables this.
+   *
+   * @param interval
+   */
+  void SetSyncInterval(size_t interval) { this->sync_interval_ = interval; }
+
+  /**
+   * @brief Return true when the buffer is full.
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Full() const { return this->state_.full != 0; }
+  /**
+   * @brief Return true when the buffer is empty
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Empty() const {
+    return !this->state_.full && this->state_.tail == this->state_.head;
+  }
+  void Clear() {
+    this->state_.head = 0;
+    this->state_.tail = 0;
+    this->state_.full = 0;
+    this->commit_();
+  }
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+  /**
+   * @brief Return the amount of elements in the buffer, this is between 0 and
+   * size.
+   *
+   * @return size_t
+   */
+  size_t Size() const {
+    if (this->state_.full) return SIZE;
+    if (this->state_.tail >= this->state_.head)
+      return size_t(this->state_.tail - this->state_.head);
+    return size_t(SIZE + this->state_.tail - this->state_.head);
+  }
+  /**
+   * @brief Push data to the end of the buffer.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(const T& data) {
+    if (this->Full()) return -1;
+    this->PushForce(data);
+    return 0;
+  }
+  /**
+   * @brief Push data to the end of the buffer, even if the buffer is full.
+   *
+   * @param data[in]
+   */
+  void PushForce(const T& data) {
+    if (this->state_.full) {
+      // Drop the oldest record before its slot is overwritten, otherwise a
+      // crash in between leaves the newest record at the front
+      if (++(this->state_.head) == SIZE) this->state_.head = 0;
+      this->state_.full = 0;
+      this->commit_();
+    }
+    Record& record = this->file_->records[this->state_.tail];
+    record.sequence = this->state_.count;
+    std::memcpy(&record.data, &data, sizeof(T));
+    record.checksum = record_checksum_(record);
+
+    if (++(this->state_.tail) == SIZE) this->state_.tail = 0;
+    this->state_.full = (this->state_.tail == this->state_.head);
+    ++(this->state_.count);
+    this->commit_();
+  }
+  /**
+   * @brief Get the data that is at the front of the buffer
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(T* data) {
+    if (this->Empty()) return -1;
+    std::memcpy(data, &this->file_->records[this->state_.head].data,
+                sizeof(T));
+    return this->Pop();
+  }
+  /**
+   * @brief Remove the data this is at the front of the buffer
+   *
+   * @return int Returns 0 on success, -1 when there is no data.
+   */
+  int Pop() {
+    if (this->Empty()) return -1;
+    this->state_.full = 0;
+    if (++(this->state_.head) == SIZE) this->state_.head = 0;
+    this->commit_();
+    return 0;
+  }
+  /**
+   * @brief Get the data that in the front of the buffer, without removing it.
+   *
+   * @param data
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Peek(const T** data) const {
+    if (this->Empty()) return -1;
+    *data = &this->file_->records[this->state_.head].data;
+    return 0;
+  }
+  /**
+   * @brief Get the element at index, counted from the front.
+   *
+   * @param index
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when index is out of range
+   */
+  int At(size_t index, const T** data) const {
+    if (index >= this->Size()) return -1;
+    size_t i = size_t(this->state_.head) + index;
+    if (i >= SIZE) i -= SIZE;
+    *data = &this->file_->records[i].data;
+    return 0;
+  }
+
+ protected:
+  struct Header {
+    uint32_t magic{kMagic};
+    uint32_t version{kVersion};
+    uint32_t element_size{uint32_t(sizeof(T))};
+    uint32_t capacity{uint32_t(SIZE)};
+    uint64_t sequence{0};  // The valid copy with the highest sequence wins
+    uint64_t count{0};     // Total amount of pushes, used for the records
+    uint64_t head{0};
+    uint64_t tail{0};
+    uint32_t full{0};
+    uint32_t reserved{0};
+    uint64_t checksum{0};
+  };
+  struct Record {
+    uint64_t sequence;
+    T data;
+    uint64_t checksum;
+  };
+  struct File {
+    Header headers[2];
+    Record records[SIZE];
+  };
+
+  File* file_{nullptr};
+  Header state_;
+  size_t sync_interval_{0};
+  size_t unsynced_{0};
+
+  /// @brief FNV-1a
+  static uint64_t checksum_(const void* data, size_t length,
+                            uint64_t hash = 0xcbf29ce484222325ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) {
+      hash ^= bytes[i];
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+  static uint64_t header_checksum_(const Header& header) {
+    return checksum_(&header, offsetof(Header, checksum));
+  }
+  static uint64_t record_checksum_(const Record& record) {
+    return checksum_(&record.data, sizeof(T),
+                     checksum_(&record.sequence, sizeof(record.sequence)));
+  }
+
+  /// @brief Write the state to the older header copy.
+  void commit_() {
+    // Make sure the record is written before the header that refers to it
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    ++(this->state_.sequence);
+    this->state_.checksum = header_checksum_(this->state_);
+    this->file_->headers[this->state_.sequence & 1] = this->state_;
+    if (this->sync_interval_ && ++(this->unsynced_) >= this->sync_interval_)
+      this->Sync();
+  }
+  bool header_valid_(const Header& header) const {
+    return header.magic == kMagic && header.version == kVersion &&
+           header.element_size == sizeof(T) && header.capacity == SIZE &&
+           header.head < SIZE && header.tail < SIZE &&
+           header.checksum == header_checksum_(header);
+  }
+  int recover_() {
+    const Header& a = this->file_->headers[0];
+    const Header& b = this->file_->headers[1];
+    const bool a_valid = this->header_valid_(a);
+    const bool b_valid = this->header_valid_(b);
+    if (!a_valid && !b_valid) return -1;
+    if (a_valid && (!b_valid || a.sequence > b.sequence))
+      this->state_ = a;
+    else
+      this->state_ = b;
+
+    // Drop records at the end that did not make it to the file intact (only
+    // possible when the OS crashed between two msync calls).
+    while (!this->Empty()) {
+      const size_t last =
+          this->state_.tail == 0 ? SIZE - 1 : size_t(this->state_.tail) - 1;
+      const Record& record = this->file_->records[last];
+      if (record.sequence == this->state_.count - 1 &&
+          record.checksum == record_checksum_(record))
+        break;
+      this->state_.tail = last;
+      this->state_.full = 0;
+      --(this->state_.count);
+    }
+    // The front record must be the one pushed Size() pushes ago
+    while (!this->Empty()) {
+      const Record& record = this->file_->records[this->state_.head];
+      if (record.sequence == this->state_.count - this->Size() &&
+          record.checksum == record_checksum_(record))
+        break;
+      if (++(this->state_.head) == SIZE) this->state_.head = 0;
+      this->state_.full = 0;
+    }
+    return 0;
+  }
+};
@@ -0,0 +1,202 @@
+/**
+ * @file record_ring_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A byte ring that stores variable length, length-prefixed records
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @brief A circular buffer of SIZE bytes that stores records of any length
+ * contiguously, so small records do not take the space of the largest one.
+ *
+ * Every record starts with a header that holds its length and is padded to
+ * kAlignment bytes. A record never wraps: when it does not fit in the bytes
+ * left at the end of the buffer, those bytes are marked with a skip header and
+ * the record is placed at the start of the buffer.
+ *
+ * The head and tail are free-running byte counters, like the power of two
+ * CircularBuffer, so the used space is a subtraction.
+ *
+ * @tparam SIZE The size of the buffer in bytes, a multiple of kAlignment
+ */
+template <size_t SIZE>
+class RecordRingBuffer {
+ public:
+  static constexpr size_t kAlignment = 8;
+  static constexpr size_t kHeaderSize = kAlignment;
+  /// @brief The largest record that fits in the buffer.
+  static constexpr size_t kMaxRecordSize = SIZE - kHeaderSize;
+
+  static_assert(SIZE >= 2 * kHeaderSize && SIZE % kAlignment == 0,
+                "RecordRingBuffer requires a SIZE that is a multiple of "
+                "kAlignment");
+
+  /**
+   * @brief Return true when there are no records in the buffer
+   *
+   * @return true
+   * @return false
+   */
+  inline bool Empty() const { return this->head_ == this->tail_; }
+  /**
+   * @brief Remove all records (and a pending reservation).
+   */
+  void Clear() {
+    this->head_ = 0;
+    this->tail_ = 0;
+    this->reserved_ = kNone;
+  }
+  /**
+   * @brief Return the size (capacity) of the buffer in bytes.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+  /**
+   * @brief Return the amount of bytes in use, including headers and padding.
+   *
+   * @return size_t
+   */
+  inline size_t Size() const { return size_t(this->tail_ - this->head_); }
+
+  /**
+   * @brief Reserve room for a record of length bytes at the end of the
+   * buffer. The record can be written in place and is added to the buffer by
+   * Commit. A new Reserve replaces a reservation that was not committed.
+   *
+   * @param length The (maximum) length of the record
+   * @param data[out] Where the record must be written
+   * @return int Returns 0 on success, -1 when out of space.
+   */
+  int Reserve(size_t length, uint8_t** data) {
+    this->reserved_ = kNone;
+    if (length > kMaxRecordSize) return -1;
+    const size_t total = record_size_(length);
+    size_t offset = size_t(this->tail_ % SIZE);
+    const size_t contiguous = SIZE - offset;
+
+    uint64_t position = this->tail_;
+    if (total > contiguous) {
+      if (this->Empty()) {
+        // Nothing to keep, just start at the beginning of the buffer
+        this->head_ += contiguous;
+        this->tail_ += contiguous;
+      } else {
+        if (SIZE - this->Size() < contiguous + total) return -1;
+        write_header_(offset, kSkip);
+      }
+      position += contiguous;
+      offset = 0;
+    } else if (SIZE - this->Size() < total) {
+      return -1;
+    }
+
+    this->reserved_ = position;
+    this->reserved_length_ = length;
+    *data = &this->buffer_[offset + kHeaderSize];
+    return 0;
+  }
+  /**
+   * @brief Add the record written after Reserve to the end of the buffer.
+   *
+   * @param length The length of the record, at most the reserved length
+   * @return int Returns 0 on success, -1 when there is no reservation or the
+   * length is larger than reserved.
+   */
+  int Commit(size_t length) {
+    if (this->reserved_ == kNone || length > this->reserved_length_) return -1;
+    write_header_(size_t(this->reserved_ % SIZE), uint32_t(length));
+    this->tail_ = this->reserved_ + record_size_(length);
+    this->reserved_ = kNone;
+    return 0;
+  }
+  /**
+   * @brief Copy a record to the end of the buffer.
+   *
+   * @param data[in]
+   * @param length
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(const void* data, size_t length) {
+    uint8_t* destination;
+    if (this->Reserve(length, &destination) != 0) return -1;
+    if (length) std::memcpy(destination, data, length);
+    return this->Commit(length);
+  }
+
+  /**
+   * @brief Get the record at the front of the buffer, without removing it.
+   *
+   * @param data[out] Points to the record, valid until it is consumed
+   * @param length[out] The length of the record
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Peek(const uint8_t** data, size_t* length) const {
+    if (this->Empty()) return -1;
+    const size_t offset = this->front_offset_();
+    *length = read_header_(offset);
+    *data = &this->buffer_[offset + kHeaderSize];
+    return 0;
+  }
+  /**
+   * @brief Remove the record at the front of the buffer.
+   *
+   * @return int Returns 0 on success, -1 when there is no data.
+   */
+  int Consume() {
+    if (this->Empty()) return -1;
+    const size_t offset = size_t(this->head_ % SIZE);
+    if (read_header_(offset) == kSkip) this->head_ += SIZE - offset;
+    this->head_ += record_size_(read_header_(size_t(this->head_ % SIZE)));
+    return 0;
+  }
+  /**
+   * @brief Copy the record at the front of the buffer and remove it.
+   *
+   * @param data[out]
+   * @param max The amount of bytes that fit in data
+   * @param length[out] The length of the record
+   * @return int Returns 0 on success, -1 when there is no data or the record
+   * is larger than max.
+   */
+  int Pop(void* data, size_t max, size_t* length) {
+    const uint8_t* record;
+    if (this->Peek(&record, length) != 0 || *length > max) return -1;
+    std::memcpy(data, record, *length);
+    return this->Consume();
+  }
+
+ protected:
+  static constexpr uint32_t kSkip = 0xFFFFFFFF;
+  static constexpr uint64_t kNone = ~uint64_t(0);
+
+  static constexpr size_t record_size_(size_t length) {
+    return kHeaderSize + (length + kAlignment - 1) / kAlignment * kAlignment;
+  }
+  void write_header_(size_t offset, uint32_t length) {
+    std::memcpy(&this->buffer_[offset], &length, sizeof(length));
+  }
+  uint32_t read_header_(size_t offset) const {
+    uint32_t length;
+    std::memcpy(&length, &this->buffer_[offset], sizeof(length));
+    return length;
+  }
+  /// @brief Return the offset of the front record, past a skip header.
+  size_t front_offset_() const {
+    const size_t offset = size_t(this->head_ % SIZE);
+    return read_header_(offset) == kSkip ? 0 : offset;
+  }
+
+  alignas(kAlignment) uint8_t buffer_[SIZE];
+  uint64_t head_{0}, tail_{0};  // Free-running byte counters
+  uint64_t reserved_{kNone};    // Position of the reserved record
+  size_t reserved_length_{0};
+};
@@ -0,0 +1,146 @@
+/**
+ * @file seqlock_ring_buffer.h
+ * @author Wouter (wjtje)
+ * @brief An overwriting "last N events" ring with one writer and any number of
+ * lock-free readers
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief A circular buffer that always overwrites the oldest element (like
+ * CircularBuffer::PushForce), written by one thread and read by any number of
+ * threads without blocking the writer.
+ *
+ * Every slot has a sequence counter that is odd while the writer is changing
+ * it and encodes which push it holds. A reader copies the slot and checks the
+ * counter before and after the copy. A torn or overwritten slot is detected
+ * instead of returned, and the reader retries or skips it.
+ *
+ * As with every seqlock the copy itself races with the writer, which is why T
+ * must be trivially copyable. The copy is only used when the counter shows it
+ * was not torn.
+ *
+ * @tparam T The type of the elements, must be trivially copyable
+ * @tparam SIZE The length of the buffer
+ */
+template <typename T, size_t SIZE>
+class SeqlockRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SeqlockRingBuffer requires a trivially copyable T");
+  static_assert(SIZE > 0, "SeqlockRingBuffer requires a non-zero SIZE");
+
+ public:
+  /**
+   * @brief Push data to the end of the buffer, overwriting the oldest element
+   * when full. May only be called from the writer thread.
+   *
+   * @param data[in]
+   */
+  void Push(const T& data) {
+    const uint64_t position = this->count_.load(std::memory_order_relaxed);
+    Slot& slot = this->slots_[position % SIZE];
+    slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.data, &data, sizeof(T));
+    slot.sequence.store(2 * position + 2, std::memory_order_release);
+    this->count_.store(position + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+  /**
+   * @brief Return the total amount of elements ever pushed.
+   *
+   * @return uint64_t
+   */
+  uint64_t Count() const {
+    return this->count_.load(std::memory_order_acquire);
+  }
+  /**
+   * @brief Return the amount of elements in the buffer, this is between 0 and
+   * size.
+   *
+   * @return size_t
+   */
+  size_t Size() const {
+    return size_t(std::min<uint64_t>(this->Count(), SIZE));
+  }
+
+  /**
+   * @brief Get the newest element, retrying when the writer overwrote it while
+   * it was being copied. Can be called from any thread.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Latest(T* data) const {
+    for (;;) {
+      const uint64_t count = this->Count();
+      if (count == 0) return -1;
+      if (this->read_(count - 1, data)) return 0;
+    }
+  }
+  /**
+   * @brief Copy the newest (at most max) elements, from oldest to newest. Can
+   * be called from any thread.
+   *
+   * Elements that the writer overwrote during the copy are left out, together
+   * with everything older, so the result is always a consistent run of
+   * consecutive elements ending at the newest element at the start of the call.
+   *
+   * @param data[out]
+   * @param max The amount of elements that fit in data
+   * @return size_t The amount of elements copied
+   */
+  size_t Snapshot(T* data, size_t max) const {
+    const uint64_t end = this->Count();
+    const uint64_t n = std::min<uint64_t>({end, SIZE, max});
+    size_t copied = 0;
+    for (uint64_t position = end - n; position < end; ++position) {
+      if (this->read_(position, &data[copied]))
+        ++copied;
+      else
+        copied = 0;  // Lapped by the writer, drop this and all older elements
+    }
+    return copied;
+  }
+
+ protected:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    T data;
+  };
+
+  /**
+   * @brief Copy the element that was pushed at position.
+   *
+   * @return bool Returns false when the slot no longer (or not yet) holds
+   * position, or when it was changed during the copy.
+   */
+  bool read_(uint64_t position, T* data) const {
+    const Slot& slot = this->slots_[position % SIZE];
+    const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2 * position + 2) return false;
+    std::memcpy(data, &slot.data, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == before;
+  }
+
+  Slot slots_[SIZE];
+  alignas(64) std::atomic<uint64_t> count_{0};
+};
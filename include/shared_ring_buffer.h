@@ -0,0 +1,388 @@
+/**
+ * @file shared_ring_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A single-producer/single-consumer circular buffer in shared memory,
+ * for exchanging records between two processes (POSIX only)
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief A lock-free circular buffer whose header and slots live in a shared
+ * memory object, so one producer process and one consumer process can
+ * exchange records without copying them through the kernel.
+ *
+ * The region has a fixed, versioned layout: a header with the magic, version,
+ * element size and capacity, followed by the producer and consumer cache
+ * lines and the slots. The head and tail are free-running counters, so
+ * nothing in the region depends on where it is mapped.
+ *
+ * Each side registers its role, which stores its pid in the header. The other
+ * side can then detect a crash with ProducerAlive or ConsumerAlive. A pid can
+ * be reused after a process exits, so this detects a crash quickly but may
+ * miss it when the pid is recycled.
+ *
+ * @tparam T The type of the records, must be trivially copyable
+ * @tparam SIZE The length of the buffer
+ */
+template <typename T, size_t SIZE>
+class SharedRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SharedRingBuffer requires a trivially copyable T");
+  static_assert(SIZE > 0, "SharedRingBuffer requires a non-zero SIZE");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                    std::atomic<int32_t>::is_always_lock_free,
+                "SharedRingBuffer requires address-free atomics");
+
+ public:
+  static constexpr size_t kCacheLineSize = 64;
+  static constexpr uint32_t kMagic = 0x31425253;  // "SRB1"
+  static constexpr uint32_t kVersion = 1;
+
+  /**
+   * @brief A contiguous range of records inside the buffer.
+   */
+  struct Span {
+    T* data;
+    size_t size;
+
+    T* begin() const { return data; }
+    T* end() const { return data + size; }
+    bool Empty() const { return size == 0; }
+  };
+
+  SharedRingBuffer() = default;
+  SharedRingBuffer(const SharedRingBuffer&) = delete;
+  SharedRingBuffer& operator=(const SharedRingBuffer&) = delete;
+  ~SharedRingBuffer() { this->Close(); }
+
+  /**
+   * @brief Create a new shared memory object and initialize the buffer in it.
+   *
+   * @param name The name passed to shm_open, for example "/acquisition"
+   * @return int Returns 0 on success, -1 when the object already exists or
+   * could not be created.
+   */
+  int Create(const char* name) {
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return -1;
+    const int result = this->Create(fd);
+    close(fd);
+    if (result != 0) shm_unlink(name);
+    return result;
+  }
+  /**
+   * @brief Initialize the buffer in an empty file descriptor, for example one
+   * from memfd_create that is passed to the other process.
+   *
+   * @param fd The file descriptor, it is not closed
+   * @return int Returns 0 on success, -1 when it could not be mapped.
+   */
+  int Create(int fd) {
+    this->Close();
+    if (ftruncate(fd, off_t(sizeof(Region))) != 0) return -1;
+    if (this->map_(fd) != 0) return -1;
+
+    // The region may already hold a buffer, retract the magic first so a
+    // concurrent Open does not attach to a half initialized header
+    Header& header = this->region_->header;
+    header.magic.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header.element_size.store(uint32_t(sizeof(T)), std::memory_order_relaxed);
+    header.capacity.store(uint32_t(SIZE), std::memory_order_relaxed);
+    header.version.store(kVersion, std::memory_order_relaxed);
+    header.head.store(0, std::memory_order_relaxed);
+    header.tail.store(0, std::memory_order_relaxed);
+    header.producer_pid.store(0, std::memory_order_relaxed);
+    header.consumer_pid.store(0, std::memory_order_relaxed);
+    this->cached_head_ = 0;
+    this->cached_tail_ = 0;
+    // The magic is published last, Open rejects a region without it
+    header.magic.store(kMagic, std::memory_order_release);
+    return 0;
+  }
+  /**
+   * @brief Open a shared memory object created with Create.
+   *
+   * @param name The name passed to shm_open
+   * @return int Returns 0 on success, -1 when it does not exist (yet) or has
+   * a different layout.
+   */
+  int Open(const char* name) {
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return -1;
+    const int result = this->Open(fd);
+    close(fd);
+    return result;
+  }
+  /**
+   * @brief Open a buffer that was created in fd by another process.
+   *
+   * @param fd The file descriptor, it is not closed
+   * @return int Returns 0 on success, -1 when it is not (yet) initialized, is
+   * being initialized by Create at the same time or has a different layout.
+   */
+  int Open(int fd) {
+    this->Close();
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) != sizeof(Region)) return -1;
+    if (this->map_(fd) != 0) return -1;
+
+    // Read the header like a seqlock: a Create that runs in between retracts
+    // the magic, so it no longer matches when it is loaded again
+    const Header& header = this->region_->header;
+    const bool valid =
+        header.magic.load(std::memory_order_acquire) == kMagic &&
+        header.version.load(std::memory_order_relaxed) == kVersion &&
+        header.element_size.load(std::memory_order_relaxed) == sizeof(T) &&
+        header.capacity.load(std::memory_order_relaxed) == SIZE;
+    this->cached_head_ = header.head.load(std::memory_order_acquire);
+    this->cached_tail_ = header.tail.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!valid || header.magic.load(std::memory_order_relaxed) != kMagic) {
+      this->Close();
+      return -1;
+    }
+    return 0;
+  }
+  /**
+   * @brief Give up the registered role and unmap the buffer.
+   */
+  void Close() {
+    if (!this->region_) return;
+    this->release_role_(this->region_->header.producer_pid);
+    this->release_role_(this->region_->header.consumer_pid);
+    munmap(this->region_, sizeof(Region));
+    this->region_ = nullptr;
+  }
+  /**
+   * @brief Remove the name of a shared memory object, mappings stay valid.
+   *
+   * @param name The name passed to shm_open
+   * @return int Returns 0 on success, -1 when it does not exist.
+   */
+  static int Unlink(const char* name) { return shm_unlink(name) == 0 ? 0 : -1; }
+
+  /**
+   * @brief Register this process as the producer.
+   *
+   * @return int Returns 0 on success, -1 when a living process already is the
+   * producer.
+   */
+  int RegisterProducer() {
+    return this->register_role_(this->region_->header.producer_pid);
+  }
+  /**
+   * @brief Register this process as the consumer.
+   *
+   * @return int Returns 0 on success, -1 when a living process already is the
+   * consumer.
+   */
+  int RegisterConsumer() {
+    return this->register_role_(this->region_->header.consumer_pid);
+  }
+  /**
+   * @brief Return true when a producer is registered and its process exists.
+   *
+   * @return true
+   * @return false
+   */
+  bool ProducerAlive() const {
+    return alive_(this->region_->header.producer_pid);
+  }
+  /**
+   * @brief Return true when a consumer is registered and its process exists.
+   *
+   * @return true
+   * @return false
+   */
+  bool ConsumerAlive() const {
+    return alive_(this->region_->header.consumer_pid);
+  }
+
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+  /**
+   * @brief Return the amount of records in the buffer, this is between 0 and
+   * size.
+   *
+   * @return size_t
+   */
+  size_t Size() const {
+    const Header& header = this->region_->header;
+    const uint64_t head = header.head.load(std::memory_order_acquire);
+    const uint64_t tail = header.tail.load(std::memory_order_acquire);
+    return size_t(tail - head);
+  }
+  /**
+   * @brief Return true when the buffer is empty.
+   *
+   * @return true
+   * @return false
+   */
+  bool Empty() const { return this->Size() == 0; }
+
+  /**
+   * @brief Push data to the end of the buffer. May only be called from the
+   * producer.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(const T& data) {
+    Span span = this->WriteAcquire(1);
+    if (span.Empty()) return -1;
+    *span.data = data;
+    return this->WriteCommit(1);
+  }
+  /**
+   * @brief Get the data that is at the front of the buffer. May only be
+   * called from the consumer.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(T* data) {
+    Span span = this->ReadAcquire(1);
+    if (span.Empty()) return -1;
+    *data = *span.data;
+    return this->ReadRelease(1);
+  }
+  /**
+   * @brief Get direct access to the free slots at the end of the buffer, so
+   * records can be written in place. Call WriteCommit to publish them. May
+   * only be called from the producer.
+   *
+   * @param max The maximum amount of records that will be written
+   * @return Span A contiguous writable range of at most max records, this is
+   * empty when the buffer is full.
+   */
+  Span WriteAcquire(size_t max = SIZE) {
+    Header& header = this->region_->header;
+    const uint64_t tail = header.tail.load(std::memory_order_relaxed);
+    if (tail - this->cached_head_ == SIZE)
+      this->cached_head_ = header.head.load(std::memory_order_acquire);
+    const size_t index = size_t(tail % SIZE);
+    const size_t n = std::min(
+        {max, size_t(SIZE - (tail - this->cached_head_)), SIZE - index});
+    return Span{&this->region_->slots[index], n};
+  }
+  /**
+   * @brief Publish count records, written in place after WriteAcquire, to the
+   * consumer.
+   *
+   * @param count The amount of records written
+   * @return int Returns 0 on success, -1 when count exceeds the free space.
+   */
+  int WriteCommit(size_t count) {
+    Header& header = this->region_->header;
+    const uint64_t tail = header.tail.load(std::memory_order_relaxed);
+    if (count > SIZE - (tail - this->cached_head_)) return -1;
+    header.tail.store(tail + count, std::memory_order_release);
+    return 0;
+  }
+  /**
+   * @brief Get direct access to the records at the front of the buffer, so
+   * they can be read in place. Call ReadRelease to hand the slots back to the
+   * producer. May only be called from the consumer.
+   *
+   * @param max The maximum amount of records that will be read
+   * @return Span A contiguous range of at most max records, this is empty when
+   * the buffer is empty.
+   */
+  Span ReadAcquire(size_t max = SIZE) {
+    Header& header = this->region_->header;
+    const uint64_t head = header.head.load(std::memory_order_relaxed);
+    if (head == this->cached_tail_)
+      this->cached_tail_ = header.tail.load(std::memory_order_acquire);
+    const size_t index = size_t(head % SIZE);
+    const size_t n =
+        std::min({max, size_t(this->cached_tail_ - head), SIZE - index});
+    return Span{&this->region_->slots[index], n};
+  }
+  /**
+   * @brief Remove count records, read in place after ReadAcquire, from the
+   * front of the buffer.
+   *
+   * @param count The amount of records read
+   * @return int Returns 0 on success, -1 when count exceeds the amount of
+   * records available.
+   */
+  int ReadRelease(size_t count) {
+    Header& header = this->region_->header;
+    const uint64_t head = header.head.load(std::memory_order_relaxed);
+    if (count > this->cached_tail_ - head) return -1;
+    header.head.store(head + count, std::memory_order_release);
+    return 0;
+  }
+
+ protected:
+  struct Header {
+    std::atomic<uint32_t> magic;
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> element_size;
+    std::atomic<uint32_t> capacity;
+    // Producer side
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail;
+    std::atomic<int32_t> producer_pid;
+    // Consumer side
+    alignas(kCacheLineSize) std::atomic<uint64_t> head;
+    std::atomic<int32_t> consumer_pid;
+  };
+  struct Region {
+    Header header;
+    alignas(kCacheLineSize) T slots[SIZE];
+  };
+  static_assert(std::is_standard_layout_v<Header>,
+                "SharedRingBuffer requires a fixed header layout");
+
+  int map_(int fd) {
+    void* addr = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) return -1;
+    this->region_ = static_cast<Region*>(addr);
+    return 0;
+  }
+  static bool alive_(const std::atomic<int32_t>& role) {
+    const pid_t pid = role.load(std::memory_order_acquire);
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+  }
+  int register_role_(std::atomic<int32_t>& role) {
+    const int32_t self = int32_t(getpid());
+    int32_t current = role.load(std::memory_order_acquire);
+    for (;;) {
+      if (current == self) return 0;
+      // Only take over the role from a process that no longer exists
+      if (current != 0 && alive_(role)) return -1;
+      if (role.compare_exchange_weak(current, self)) return 0;
+    }
+  }
+  void release_role_(std::atomic<int32_t>& role) {
+    int32_t self = int32_t(getpid());
+    role.compare_exchange_strong(self, 0);
+  }
+
+  Region* region_{nullptr};
+  // Process local
+  uint64_t cached_head_{0};  // Used by the producer
+  uint64_t cached_tail_{0};  // Used by the consumer
+};
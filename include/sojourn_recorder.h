@@ -0,0 +1,84 @@
+/**
+ * @file sojourn_recorder.h
+ * @author Wouter (wjtje)
+ * @brief An instrumentation policy that measures how long elements wait in a
+ * CircularBuffer
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+#include "circular_buffer.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief Timestamps every element when it is pushed and records its sojourn
+ * (waiting) time in a LatencyHistogram when it is popped.
+ *
+ * @code
+ * CircularBuffer<Event, 256, SojournRecorder<256>> events;
+ * auto p99 = events.SojournPercentile(0.99);
+ * @endcode
+ *
+ * The timestamps are kept in their own CircularBuffer, in the same order as
+ * the elements. Elements that are overwritten by PushForce or removed by Clear
+ * are not recorded. A copy of the buffer keeps the push times of the copied
+ * elements. The percentiles can be read from any thread while the buffer is in
+ * use.
+ *
+ * SIZE has to match the length of the buffer, a CircularBuffer of another
+ * length does not compile.
+ *
+ * @tparam SIZE The length of the instrumented buffer
+ * @tparam Clock The clock used for the timestamps, the histogram is in ticks
+ * of its duration
+ */
+template <size_t SIZE, typename Clock = std::chrono::steady_clock>
+class SojournRecorder {
+ public:
+  /// @brief The length of the instrumented buffer, checked by CircularBuffer.
+  static constexpr size_t kSize = SIZE;
+
+  /**
+   * @brief Return the histogram of the sojourn times, in Clock ticks.
+   *
+   * @return const LatencyHistogram&
+   */
+  const LatencyHistogram& SojournHistogram() const { return this->histogram_; }
+  /**
+   * @brief Return the sojourn time below which a fraction q of the popped
+   * elements fall, for example 0.999 for p999. Can be called from any thread.
+   *
+   * @param q The quantile, between 0 and 1
+   * @return Clock::duration
+   */
+  typename Clock::duration SojournPercentile(double q) const {
+    return typename Clock::duration(
+        typename Clock::rep(this->histogram_.Percentile(q)));
+  }
+
+ protected:
+  void on_push_(size_t count, size_t /*size*/) {
+    const typename Clock::time_point now = Clock::now();
+    for (; count > 0; --count) this->timestamps_.PushForce(now);
+  }
+  void on_reject_(size_t /*count*/) {}
+  void on_overwrite_() { this->timestamps_.Pop(); }
+  void on_pop_(size_t count) {
+    const typename Clock::time_point now = Clock::now();
+    for (; count > 0 && !this->timestamps_.Empty(); --count) {
+      const typename Clock::duration sojourn =
+          now - this->timestamps_.DirectPop();
+      this->histogram_.Record(uint64_t(sojourn.count()));
+    }
+  }
+  void on_clear_() { this->timestamps_.Clear(); }
+
+ private:
+  CircularBuffer<typename Clock::time_point, SIZE> timestamps_;
+  LatencyHistogram histogram_;
+};
@@ -0,0 +1,153 @@
+/**
+ * @file spsc_circular_buffer.h
+ * @author Wouter (wjtje)
+ * @brief A lock-free single-producer/single-consumer circular buffer
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief A lock-free circular buffer for exactly one producer thread and one
+ * consumer thread, using a static buffer.
+ *
+ * Unlike CircularBuffer there is no shared `full_` flag. The head and tail are
+ * free-running counters, the buffer is full when they are SIZE apart. Each
+ * index is only written by one side and lives on its own cache line, next to
+ * a cached copy of the other side's index so the common case does not touch
+ * the other core's cache line at all.
+ *
+ * @tparam T The type of the static buffer
+ * @tparam SIZE The length of the buffer
+ */
+template <typename T, size_t SIZE>
+class SpscCircularBuffer {
+  static_assert(SIZE > 0, "SpscCircularBuffer requires a non-zero SIZE");
+
+ public:
+  static constexpr size_t kCacheLineSize = 64;
+
+  /**
+   * @brief Return true when the buffer is full.
+   * @note The result may be outdated by the time it is used, only the
+   * consumer can rely on a false result.
+   *
+   * @return true
+   * @return false
+   */
+  bool Full() const { return this->Size() == SIZE; }
+  /**
+   * @brief Return true when the buffer is empty.
+   * @note The result may be outdated by the time it is used, only the
+   * producer can rely on a false result.
+   *
+   * @return true
+   * @return false
+   */
+  bool Empty() const {
+    return this->tail_.load(std::memory_order_acquire) ==
+           this->head_.load(std::memory_order_acquire);
+  }
+  /**
+   * @brief Return the size (capacity) of the buffer.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+  /**
+   * @brief Return the amount of elements in the buffer, this is between 0 and
+   * size.
+   * @note Only exact on the producer or consumer thread, other threads get an
+   * approximation that is clamped to SIZE.
+   *
+   * @return size_t
+   */
+  size_t Size() const {
+    const size_t head = this->head_.load(std::memory_order_acquire);
+    const size_t tail = this->tail_.load(std::memory_order_acquire);
+    // Another thread can load a tail that moved on after the head was loaded,
+    // the difference may then exceed SIZE while the real size never does
+    const size_t size = tail - head;
+    return size < SIZE ? size : SIZE;
+  }
+  /**
+   * @brief Push data to the end of the buffer. May only be called from the
+   * producer thread.
+   *
+   * @param data[in]
+   * @return int Return 0 on success, -1 when out of space.
+   */
+  int Push(const T& data) {
+    const size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail - this->cached_head_ == SIZE) {
+      this->cached_head_ = this->head_.load(std::memory_order_acquire);
+      if (tail - this->cached_head_ == SIZE) return -1;
+    }
+    this->buffer_[tail % SIZE] = data;
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return 0;
+  }
+  /**
+   * @brief Get the data that is at the front of the buffer. May only be
+   * called from the consumer thread.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(T* data) {
+    const size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head == this->cached_tail_) {
+      this->cached_tail_ = this->tail_.load(std::memory_order_acquire);
+      if (head == this->cached_tail_) return -1;
+    }
+    *data = this->buffer_[head % SIZE];
+    this->head_.store(head + 1, std::memory_order_release);
+    return 0;
+  }
+  /**
+   * @brief Remove the data this is at the front of the buffer. May only be
+   * called from the consumer thread.
+   *
+   * @return int Returns 0 on success, -1 when there is no data.
+   */
+  int Pop() {
+    const size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head == this->cached_tail_) {
+      this->cached_tail_ = this->tail_.load(std::memory_order_acquire);
+      if (head == this->cached_tail_) return -1;
+    }
+    this->head_.store(head + 1, std::memory_order_release);
+    return 0;
+  }
+  /**
+   * @brief Get the data that in the front of the buffer, without removing it.
+   * May only be called from the consumer thread.
+   *
+   * @param data
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Peek(T** data) {
+    const size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head == this->cached_tail_) {
+      this->cached_tail_ = this->tail_.load(std::memory_order_acquire);
+      if (head == this->cached_tail_) return -1;
+    }
+    *data = &this->buffer_[head % SIZE];
+    return 0;
+  }
+
+ protected:
+  T buffer_[SIZE];
+
+  // Consumer side: the head is written by the consumer only.
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  size_t cached_tail_{0};
+
+  // Producer side: the tail is written by the producer only.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  size_t cached_head_{0};
+};
@@ -0,0 +1,212 @@
+/**
+ * @file timing_wheel.h
+ * @author Wouter (wjtje)
+ * @brief A hierarchical timing wheel with O(1) schedule and cancel
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <cstddef>
+
+#include "circular_buffer.h"
+
+/**
+ * @brief A hashed hierarchical timing wheel (Varghese and Lauck).
+ *
+ * Every level is a CircularBuffer of kSlots timer lists. The front of a level
+ * is the slot of the current time, so a timer is linked into the list at its
+ * distance from the front. Level 0 has a slot per tick, every next level has
+ * a slot per kSlots slots of the level below. When the front of a level moves
+ * to a new slot, its timers are cascaded to the lower levels.
+ *
+ * Timers are intrusive: derive from (or embed) a Timer, the wheel never
+ * allocates. Schedule and Cancel are O(1), Advance is amortized O(1) per tick
+ * plus the work for the timers that expire. Timers further away than the top
+ * level can hold are parked in its last slot and rescheduled when it comes
+ * around.
+ *
+ * @tparam LEVELS The amount of levels
+ * @tparam SLOT_BITS The log2 of the amount of slots per level
+ */
+template <size_t LEVELS = 4, size_t SLOT_BITS = 8>
+class TimingWheel {
+  static_assert(LEVELS > 0 && SLOT_BITS > 0 && LEVELS * SLOT_BITS <= 64,
+                "TimingWheel requires LEVELS * SLOT_BITS <= 64");
+
+ public:
+  static constexpr size_t kSlots = size_t(1) << SLOT_BITS;
+
+  /**
+   * @brief A timer, it must stay at the same address while it is scheduled.
+   */
+  struct Timer {
+    Timer* next{nullptr};
+    Timer** pprev{nullptr};  // The pointer that points to this timer
+    uint64_t expires{0};     // The tick at which the timer expires
+
+    /**
+     * @brief Return true when the timer is scheduled.
+     *
+     * @return true
+     * @return false
+     */
+    bool Scheduled() const { return this->pprev != nullptr; }
+  };
+
+  TimingWheel() {
+    for (Level& level : this->levels_)
+      for (size_t i = 0; i < kSlots; ++i) level.Push(TimerList{});
+  }
+  // Scheduled timers point into the wheel
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  /**
+   * @brief Return the current tick.
+   *
+   * @return uint64_t
+   */
+  uint64_t Now() const { return this->now_; }
+  /**
+   * @brief Return the amount of scheduled timers.
+   *
+   * @return size_t
+   */
+  size_t Size() const { return this->size_; }
+  /**
+   * @brief Return true when no timers are scheduled
+   *
+   * @return true
+   * @return false
+   */
+  bool Empty() const { return this->size_ == 0; }
+
+  /**
+   * @brief Schedule a timer to expire after ticks, a timer that is already
+   * scheduled is moved. A delay of 0 expires at the next tick.
+   *
+   * @param timer The timer, it must outlive its scheduled time
+   * @param ticks The delay from now
+   */
+  void Schedule(Timer* timer, uint64_t ticks) {
+    if (timer->Scheduled())
+      unlink_(timer);
+    else
+      ++(this->size_);
+    timer->expires = this->now_ + (ticks == 0 ? 1 : ticks);
+    this->insert_(timer);
+  }
+  /**
+   * @brief Cancel a scheduled timer.
+   *
+   * @param timer
+   * @return int Returns 0 on success, -1 when the timer was not scheduled.
+   */
+  int Cancel(Timer* timer) {
+    if (!timer->Scheduled()) return -1;
+    unlink_(timer);
+    --(this->size_);
+    return 0;
+  }
+  /**
+   * @brief Move the time forward and call on_expire for every timer that
+   * expires. The callback may schedule and cancel timers.
+   *
+   * @param ticks The amount of ticks to advance
+   * @param on_expire Called as on_expire(Timer*), the timer is no longer
+   * scheduled
+   * @return size_t The amount of expired timers
+   */
+  template <typename F>
+  size_t Advance(uint64_t ticks, F on_expire) {
+    size_t expired = 0;
+    for (; ticks > 0; --ticks) {
+      this->rotate_(0);
+      ++(this->now_);
+      // Rotate every level whose slot changed, then cascade their new front
+      // slots starting at the top
+      size_t wrapped = 0;
+      while (wrapped + 1 < LEVELS && (this->now_ & mask_(wrapped + 1)) == 0)
+        this->rotate_(++wrapped);
+      for (size_t l = wrapped; l > 0; --l) {
+        TimerList pending;
+        take_(this->levels_[l].Front(), &pending);
+        while (pending.head) {
+          Timer* timer = pending.head;
+          unlink_(timer);
+          this->insert_(timer);
+        }
+      }
+
+      TimerList pending;
+      take_(this->levels_[0].Front(), &pending);
+      while (pending.head) {
+        Timer* timer = pending.head;
+        unlink_(timer);
+        --(this->size_);
+        ++expired;
+        on_expire(timer);
+      }
+    }
+    return expired;
+  }
+
+ protected:
+  struct TimerList {
+    Timer* head{nullptr};
+  };
+  typedef CircularBuffer<TimerList, kSlots> Level;
+
+  /// @brief Return a mask for the ticks below level.
+  static constexpr uint64_t mask_(size_t level) {
+    return level * SLOT_BITS >= 64 ? ~uint64_t(0)
+                                   : (uint64_t(1) << (level * SLOT_BITS)) - 1;
+  }
+  static void link_(TimerList& list, Timer* timer) {
+    timer->next = list.head;
+    if (list.head) list.head->pprev = &timer->next;
+    list.head = timer;
+    timer->pprev = &list.head;
+  }
+  static void unlink_(Timer* timer) {
+    *timer->pprev = timer->next;
+    if (timer->next) timer->next->pprev = timer->pprev;
+    timer->next = nullptr;
+    timer->pprev = nullptr;
+  }
+  /// @brief Move all timers of list to pending.
+  static void take_(TimerList& list, TimerList* pending) {
+    pending->head = list.head;
+    if (pending->head) pending->head->pprev = &pending->head;
+    list.head = nullptr;
+  }
+
+  /// @brief Move the front of a level to the next slot, it must be empty.
+  void rotate_(size_t level) {
+    this->levels_[level].Pop();
+    this->levels_[level].Push(TimerList{});
+  }
+  /// @brief Link a timer with expires >= now into the lowest level that can
+  /// hold it.
+  void insert_(Timer* timer) {
+    const uint64_t expires = timer->expires;
+    for (size_t l = 0;; ++l) {
+      const size_t shift = l * SLOT_BITS;
+      if (l + 1 == LEVELS || (expires >> (shift + SLOT_BITS)) ==
+                                 (this->now_ >> (shift + SLOT_BITS))) {
+        uint64_t offset = (expires >> shift) - (this->now_ >> shift);
+        if (offset >= kSlots) offset = kSlots - 1;  // Parked in the top level
+        link_(this->levels_[l][size_t(offset)], timer);
+        return;
+      }
+    }
+  }
+
+  Level levels_[LEVELS];
+  uint64_t now_{0};
+  size_t size_{0};
+};
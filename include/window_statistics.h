@@ -0,0 +1,218 @@
+/**
+ * @file window_statistics.h
+ * @author Wouter (wjtje)
+ * @brief Running statistics over the last SIZE samples
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+
+#include "circular_buffer.h"
+
+/**
+ * @brief Keeps the last SIZE samples in a CircularBuffer, together with the
+ * running sum, the sum of squares and two monotonic queues for the minimum and
+ * maximum. All queries are O(1), a Push is amortized O(1) also when it evicts
+ * the oldest sample.
+ *
+ * The sums are kept relative to an offset, which keeps the variance accurate
+ * when the samples have a large offset. Every SIZE samples the offset is moved
+ * to the current mean and the sums are recomputed, so they follow a drifting
+ * signal and do not accumulate rounding errors. This is O(SIZE) once per SIZE
+ * pushes.
+ *
+ * @tparam T The type of the samples, must be convertible to double
+ * @tparam SIZE The amount of samples in the window
+ */
+template <typename T, size_t SIZE>
+class WindowStatistics {
+ public:
+  /**
+   * @brief Add a sample, evicting the oldest sample when the window is full.
+   *
+   * @param sample[in]
+   */
+  void Push(const T& sample) {
+    if (this->samples_.Full()) {
+      const double oldest = double(this->samples_.Front()) - this->offset_;
+      this->sum_ -= oldest;
+      this->sum_squares_ -= oldest * oldest;
+      const uint64_t evicted = this->sequence_ - SIZE;
+      this->min_.Evict(evicted);
+      this->max_.Evict(evicted);
+    } else if (this->samples_.Empty()) {
+      this->offset_ = double(sample);
+    }
+    this->samples_.PushForce(sample);
+
+    const double value = double(sample) - this->offset_;
+    this->sum_ += value;
+    this->sum_squares_ += value * value;
+    this->min_.Push(sample, this->sequence_);
+    this->max_.Push(sample, this->sequence_);
+    if (++(this->sequence_) % SIZE == 0) this->rebase_();
+  }
+  /**
+   * @brief Remove all samples.
+   */
+  void Clear() {
+    this->samples_.Clear();
+    this->min_.Clear();
+    this->max_.Clear();
+    this->sum_ = 0;
+    this->sum_squares_ = 0;
+    this->offset_ = 0;
+  }
+
+  /**
+   * @brief Return true when the window is empty
+   *
+   * @return true
+   * @return false
+   */
+  bool Empty() const { return this->samples_.Empty(); }
+  /**
+   * @brief Return true when the window holds SIZE samples
+   *
+   * @return true
+   * @return false
+   */
+  bool Full() const { return this->samples_.Full(); }
+  /**
+   * @brief Return the amount of samples in the window.
+   *
+   * @return size_t
+   */
+  size_t Size() const { return this->samples_.Size(); }
+  /**
+   * @brief Return the size (capacity) of the window.
+   *
+   * @return size_t
+   */
+  inline constexpr size_t MaxSize() const { return SIZE; }
+
+  /**
+   * @brief Return the sum of the samples in the window.
+   *
+   * @return double
+   */
+  double Sum() const { return this->sum_ + this->offset_ * this->Size(); }
+  /**
+   * @brief Return the mean of the samples in the window, 0 when empty.
+   *
+   * @return double
+   */
+  double Mean() const {
+    if (this->Empty()) return 0;
+    return this->offset_ + this->sum_ / this->Size();
+  }
+  /**
+   * @brief Return the (population) variance of the samples in the window, 0
+   * when empty.
+   *
+   * @return double
+   */
+  double Variance() const {
+    if (this->Empty()) return 0;
+    const double n = double(this->Size());
+    const double mean = this->sum_ / n;
+    const double variance = this->sum_squares_ / n - mean * mean;
+    return variance > 0 ? variance : 0;
+  }
+  /**
+   * @brief Return the (population) standard deviation of the samples in the
+   * window, 0 when empty.
+   *
+   * @return double
+   */
+  double StdDev() const { return std::sqrt(this->Variance()); }
+  /**
+   * @brief Return the smallest sample in the window.
+   * @warning This value is invalid when the window is empty.
+   *
+   * @return T
+   */
+  T Min() const { return this->min_.Front(); }
+  /**
+   * @brief Return the largest sample in the window.
+   * @warning This value is invalid when the window is empty.
+   *
+   * @return T
+   */
+  T Max() const { return this->max_.Front(); }
+  /**
+   * @brief Get the samples in the window, from oldest to newest.
+   *
+   * @return const CircularBuffer<T, SIZE>&
+   */
+  const CircularBuffer<T, SIZE>& Samples() const { return this->samples_; }
+
+ private:
+  /// @brief Move the offset to the mean and recompute the sums.
+  void rebase_() {
+    this->offset_ = this->Mean();
+    this->sum_ = 0;
+    this->sum_squares_ = 0;
+    for (const T& sample : this->samples_) {
+      const double value = double(sample) - this->offset_;
+      this->sum_ += value;
+      this->sum_squares_ += value * value;
+    }
+  }
+
+  /**
+   * @brief A fixed size monotonic deque. The front is always the extreme of
+   * the samples still in the window, every sample is pushed and removed at most
+   * once.
+   */
+  template <typename Compare>
+  class MonotonicQueue {
+   public:
+    void Push(const T& value, uint64_t sequence) {
+      // Drop the samples that can never be the extreme again
+      while (this->back_ != this->front_ &&
+             !Compare()(this->at_(this->back_ - 1).value, value))
+        --(this->back_);
+      this->at_(this->back_++) = Entry{value, sequence};
+    }
+    void Evict(uint64_t sequence) {
+      if (this->back_ != this->front_ &&
+          this->at_(this->front_).sequence == sequence)
+        ++(this->front_);
+    }
+    void Clear() {
+      this->front_ = 0;
+      this->back_ = 0;
+    }
+    const T& Front() const { return this->at_(this->front_).value; }
+
+   private:
+    struct Entry {
+      T value;
+      uint64_t sequence;
+    };
+
+    Entry& at_(size_t index) { return this->entries_[index % SIZE]; }
+    const Entry& at_(size_t index) const {
+      return this->entries_[index % SIZE];
+    }
+
+    Entry entries_[SIZE];
+    size_t front_{0}, back_{0};  // Free-running
+  };
+
+  CircularBuffer<T, SIZE> samples_;
+  MonotonicQueue<std::less<T>> min_;
+  MonotonicQueue<std::greater<T>> max_;
+  double offset_{0};
+  double sum_{0};
+  double sum_squares_{0};
+  uint64_t sequence_{0};  // Sequence number of the next sample
+};
@@ -0,0 +1,183 @@
+/**
+ * @file work_stealing_deque.h
+ * @author Wouter (wjtje)
+ * @brief A growable lock-free Chase-Lev work-stealing deque
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2024 wjtje. MIT License
+ */
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief A Chase-Lev work-stealing deque, using the memory orderings from
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al.).
+ *
+ * The owner thread pushes and pops at the bottom, any other thread can steal
+ * from the top. The storage is a power of two ring indexed with free-running
+ * counters, like the power of two CircularBuffer. When it is full the owner
+ * copies it to a ring twice as large. Old rings are kept until the deque is
+ * destroyed, because a thief may still be reading from them.
+ *
+ * @tparam T The type of the elements, must be trivially copyable (typically a
+ * pointer to a task)
+ */
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "WorkStealingDeque requires a trivially copyable T");
+
+ public:
+  static constexpr size_t kCacheLineSize = 64;
+
+  /**
+   * @brief Construct a new deque.
+   *
+   * @param capacity The initial capacity, rounded up to a power of two
+   */
+  explicit WorkStealingDeque(size_t capacity = 64) {
+    size_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+    this->array_.store(new Array(rounded), std::memory_order_relaxed);
+  }
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+  ~WorkStealingDeque() {
+    delete this->array_.load(std::memory_order_relaxed);
+    for (Array* array : this->retired_) delete array;
+  }
+
+  /**
+   * @brief Return the capacity of the current ring.
+   *
+   * @return size_t
+   */
+  size_t MaxSize() const {
+    return this->array_.load(std::memory_order_relaxed)->capacity;
+  }
+  /**
+   * @brief Return the approximate amount of elements in the deque.
+   *
+   * @return size_t
+   */
+  size_t Size() const {
+    const int64_t bottom = this->bottom_.load(std::memory_order_relaxed);
+    const int64_t top = this->top_.load(std::memory_order_relaxed);
+    return bottom > top ? size_t(bottom - top) : 0;
+  }
+  /**
+   * @brief Return true when the deque is (approximately) empty.
+   *
+   * @return true
+   * @return false
+   */
+  bool Empty() const { return this->Size() == 0; }
+
+  /**
+   * @brief Push data to the bottom of the deque, growing it when it is full.
+   * May only be called from the owner thread.
+   *
+   * @param data[in]
+   */
+  void Push(const T& data) {
+    const int64_t bottom = this->bottom_.load(std::memory_order_relaxed);
+    const int64_t top = this->top_.load(std::memory_order_acquire);
+    Array* array = this->array_.load(std::memory_order_relaxed);
+    if (bottom - top > int64_t(array->capacity) - 1)
+      array = this->grow_(array, bottom, top);
+    array->Put(bottom, data);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  /**
+   * @brief Get the data at the bottom of the deque (the most recently pushed).
+   * May only be called from the owner thread.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data
+   */
+  int Pop(T* data) {
+    const int64_t bottom = this->bottom_.load(std::memory_order_relaxed) - 1;
+    Array* array = this->array_.load(std::memory_order_relaxed);
+    this->bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = this->top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      // Empty
+      this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return -1;
+    }
+    const T value = array->Get(bottom);
+    if (top == bottom) {
+      // Last element, race against the thieves for it
+      const bool won = this->top_.compare_exchange_strong(
+          top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+      // The caller's data is left untouched when a thief took the element
+      if (!won) return -1;
+    }
+    *data = value;
+    return 0;
+  }
+  /**
+   * @brief Steal the data at the top of the deque (the least recently pushed).
+   * Can be called from any thread.
+   *
+   * @param data[out]
+   * @return int Returns 0 on success, -1 when there is no data, -2 when another
+   * thread won the race for the element (retrying may succeed).
+   */
+  int Steal(T* data) {
+    int64_t top = this->top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = this->bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) return -1;
+
+    Array* array = this->array_.load(std::memory_order_acquire);
+    const T value = array->Get(top);
+    if (!this->top_.compare_exchange_strong(top, top + 1,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_relaxed))
+      return -2;
+    *data = value;
+    return 0;
+  }
+
+ protected:
+  struct Array {
+    explicit Array(size_t size)
+        : capacity(size), mask(size - 1), slots(new std::atomic<T>[size]) {}
+    ~Array() { delete[] slots; }
+
+    T Get(int64_t index) const {
+      return slots[size_t(index) & mask].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t index, const T& value) {
+      slots[size_t(index) & mask].store(value, std::memory_order_relaxed);
+    }
+
+    const size_t capacity;
+    const size_t mask;
+    std::atomic<T>* const slots;
+  };
+
+  Array* grow_(Array* array, int64_t bottom, int64_t top) {
+    Array* grown = new Array(array->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i) grown->Put(i, array->Get(i));
+    this->retired_.push_back(array);
+    this->array_.store(grown, std::memory_order_release);
+    return grown;
+  }
+
+  alignas(kCacheLineSize) std::atomic<int64_t> top_{0};
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_{0};
+  std::atomic<Array*> array_{nullptr};
+  std::vector<Array*> retired_;  // Only touched by the owner
+};
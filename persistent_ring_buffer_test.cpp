@@ -0,0 +1,74 @@
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "include/persistent_ring_buffer.h"
+
+// Kills a process that appends to a PersistentRingBuffer at random moments
+// and checks that every recovery is in order, so the recovered values are
+// consecutive.
+//
+//   g++ -std=c++17 persistent_ring_buffer_test.cpp -o test && ./test
+
+constexpr size_t kSize = 16;
+constexpr int kKills = 50;
+
+typedef PersistentRingBuffer<uint64_t, kSize> Journal;
+
+/// @brief Return the newest value in the journal, 0 when it is empty.
+uint64_t newest(const Journal& journal) {
+  const uint64_t* data;
+  if (journal.At(journal.Size() - 1, &data) != 0) return 0;
+  return *data;
+}
+
+/// @brief Return 0 when the journal holds consecutive values.
+int check(const Journal& journal) {
+  const uint64_t* previous = nullptr;
+  for (size_t i = 0; i < journal.Size(); ++i) {
+    const uint64_t* data;
+    if (journal.At(i, &data) != 0) return -1;
+    if (previous && *data != *previous + 1) return -1;
+    previous = data;
+  }
+  return 0;
+}
+
+int main() {
+  char path[] = "/tmp/persistent_ring_buffer_test_XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0) return 1;
+  close(fd);
+  unlink(path);  // Open creates the file again
+
+  int failures = 0;
+  srand(42);
+  for (int kill_count = 0; kill_count < kKills; ++kill_count) {
+    const pid_t pid = fork();
+    if (pid < 0) return 1;
+    if (pid == 0) {
+      // Keep counting from the newest recovered value
+      Journal journal;
+      if (journal.Open(path) != 0) _exit(1);
+      for (uint64_t value = newest(journal) + 1;; ++value)
+        journal.PushForce(value);
+    }
+    usleep(useconds_t(1000 + rand() % 10000));
+    kill(pid, SIGKILL);
+    int status;
+    waitpid(pid, &status, 0);
+
+    Journal journal;
+    if (journal.Open(path) != 0 || check(journal) != 0) {
+      printf("Failed: recovery %d is out of order\n", kill_count);
+      ++failures;
+    }
+  }
+  unlink(path);
+
+  if (failures == 0) printf("Success\n");
+  return failures == 0 ? 0 : 1;
+}